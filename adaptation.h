@@ -0,0 +1,171 @@
+#ifndef ADAPTATION_H
+#define ADAPTATION_H
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include "organism.h"
+#include "statistics.h"
+#include "geneticalgorithm.h"
+
+namespace ga
+{
+
+// Operator parameters which may be changed at runtime
+struct OperatorRates
+{
+    double mutationProbability = 0;
+    double mutationStep = 1;
+    std::vector<double> crossoverWeights;
+};
+
+// Outcome of the last generation: an offspring succeeds when it is better
+// than the better of its parents
+struct AdaptationFeedback
+{
+    size_t mutations = 0;
+    size_t mutationSuccesses = 0;
+    std::vector<size_t> crossoverUses;
+    std::vector<double> crossoverCredit;
+};
+
+template<typename GenType>
+class Adaptation
+{
+public:
+    virtual void reset() {}
+    virtual void adapt(const Statistics &, const AdaptationFeedback &,
+                       OperatorRates &) = 0;
+    virtual ~Adaptation() = default;
+};
+
+// Rechenberg's 1/5th success rule for the mutation step size
+template<typename GenType>
+class SuccessRuleAdaptation : public Adaptation<GenType>
+{
+public:
+    SuccessRuleAdaptation(double factor = 0.85, double targetRate = 0.2,
+                          double minStep = 1e-8, double maxStep = 1e8) :
+        factor_(factor), targetRate_(targetRate),
+        minStep_(minStep), maxStep_(maxStep) {}
+    void adapt(const Statistics &, const AdaptationFeedback &feedback,
+               OperatorRates &rates) override
+    {
+        if(!feedback.mutations) return;
+        const double rate = static_cast<double>(feedback.mutationSuccesses) /
+                feedback.mutations;
+        if(rate > targetRate_) rates.mutationStep /= factor_;
+        else if(rate < targetRate_) rates.mutationStep *= factor_;
+        rates.mutationStep = std::min(std::max(rates.mutationStep, minStep_),
+                                      maxStep_);
+    }
+
+private:
+    const double factor_;
+    const double targetRate_;
+    const double minStep_;
+    const double maxStep_;
+};
+
+// Raises the mutation probability while the population diversity is below
+// the target and lowers it otherwise
+template<typename GenType>
+class DiversityAdaptation : public Adaptation<GenType>
+{
+public:
+    DiversityAdaptation(double targetDiversity, double minProbability = 0,
+                        double maxProbability = 100, double factor = 1.1) :
+        targetDiversity_(targetDiversity),
+        minProbability_(minProbability),
+        maxProbability_(maxProbability),
+        factor_(factor) {}
+    void adapt(const Statistics &statistics, const AdaptationFeedback &,
+               OperatorRates &rates) override
+    {
+        double &probability = rates.mutationProbability;
+        if(statistics.diversity < targetDiversity_) probability *= factor_;
+        else probability /= factor_;
+        probability = std::min(std::max(probability, minProbability_),
+                               maxProbability_);
+    }
+
+private:
+    const double targetDiversity_;
+    const double minProbability_;
+    const double maxProbability_;
+    const double factor_;
+};
+
+// Adaptive operator selection: crossover weights follow the exponentially
+// smoothed mean improvement credited to every operator
+template<typename GenType>
+class ProbabilityMatching : public Adaptation<GenType>
+{
+public:
+    ProbabilityMatching(double minWeight = 0.1, double decay = 0.3) :
+        minWeight_(minWeight), decay_(decay) {}
+    void reset() override
+    {
+        quality_.clear();
+    }
+    void adapt(const Statistics &, const AdaptationFeedback &feedback,
+               OperatorRates &rates) override
+    {
+        const size_t size = rates.crossoverWeights.size();
+        if(size < 2) return;
+        quality_.resize(size, 0);
+        double sum = 0;
+        for(size_t i = 0; i < size; ++i)
+        {
+            if(feedback.crossoverUses[i])
+            {
+                const double credit = feedback.crossoverCredit[i] /
+                        feedback.crossoverUses[i];
+                quality_[i] += decay_ * (credit - quality_[i]);
+            }
+            sum += quality_[i];
+        }
+        const double minWeight = std::min(minWeight_, 1.0 / size);
+        for(size_t i = 0; i < size; ++i)
+        {
+            const double share = (sum > 0) ? quality_[i] / sum : 1.0 / size;
+            rates.crossoverWeights[i] = minWeight +
+                    (1 - size * minWeight) * share;
+        }
+    }
+
+private:
+    const double minWeight_;
+    const double decay_;
+    std::vector<double> quality_;
+};
+
+template<typename GenType>
+class CombinedAdaptation : public Adaptation<GenType>
+{
+public:
+    void add(std::unique_ptr< Adaptation<GenType> > adaptation)
+    {
+        adaptations_.push_back(std::move(adaptation));
+    }
+    void reset() override
+    {
+        for(auto &adaptation : adaptations_) adaptation->reset();
+    }
+    void adapt(const Statistics &statistics,
+               const AdaptationFeedback &feedback,
+               OperatorRates &rates) override
+    {
+        for(auto &adaptation : adaptations_)
+        {
+            adaptation->adapt(statistics, feedback, rates);
+        }
+    }
+
+private:
+    std::vector< std::unique_ptr< Adaptation<GenType> > > adaptations_;
+};
+
+}
+
+#endif // ADAPTATION_H
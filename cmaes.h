@@ -0,0 +1,421 @@
+#ifndef CMAES_H
+#define CMAES_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+#include "organism.h"
+#include "gene.h"
+#include "geneticalgorithm.h"
+#include "evolutionaryalgorithm.h"
+
+namespace ga
+{
+
+// (mu/mu_w, lambda)-CMA-ES. The initial mean is the centroid of the
+// initialized population. Covariance is kept as a contiguous row-major
+// matrix whose upper triangle is updated row by row; its
+// eigendecomposition is only recomputed every few generations.
+template<typename GenType>
+class CMAES : public EvolutionaryAlgorithm<GenType>
+{
+    using Base = EvolutionaryAlgorithm<GenType>;
+    using Base::population_;
+    using Base::initialization_;
+
+public:
+    // Population size 0 selects the default 4 + 3 ln(n)
+    CMAES(size_t chromosomeSize, size_t populationSize = 0,
+          double sigma = 0.3) :
+        Base(chromosomeSize, (populationSize) ? populationSize :
+                             defaultPopulationSize(chromosomeSize)),
+        initialSigma_(sigma),
+        sigma_(sigma),
+        gen_(std::random_device()())
+    {
+        static_assert(!std::is_same<GenType, bool>::value,
+                      "CMAES doesn't work with binary encoding!");
+    }
+
+    Organism<GenType> optimize(bool minimize = true,
+                               unsigned int numberOfThreads = 1)
+    {
+        this->start(minimize, numberOfThreads);
+        initialization_->initialize(population_);
+        this->calcFitnessForPopulation(population_);
+        this->sortPopulation(minimize);
+        this->updateStatistics(0, minimize);
+        Organism<GenType> best = population_.front();
+
+        const size_t n = best.chromosome.size();
+        const size_t lambda = population_.size();
+        const size_t mu = std::max<size_t>(lambda / 2, 1);
+        std::vector<double> weights(mu);
+        for(size_t k = 0; k < mu; ++k)
+        {
+            weights[k] = std::log(mu + 0.5) - std::log(k + 1.0);
+        }
+        double sum = 0, squares = 0;
+        for(double w : weights) sum += w;
+        for(double &w : weights)
+        {
+            w /= sum;
+            squares += w * w;
+        }
+        const double mueff = 1 / squares;
+        const double cc = (4 + mueff / n) / (n + 4 + 2 * mueff / n);
+        const double cs = (mueff + 2) / (n + mueff + 5);
+        const double c1 = 2 / ((n + 1.3) * (n + 1.3) + mueff);
+        const double cmu = std::min(1 - c1, 2 * (mueff - 2 + 1 / mueff) /
+                                    ((n + 2.0) * (n + 2.0) + mueff));
+        const double damps = 1 + cs + 2 * std::max(
+                    0.0, std::sqrt((mueff - 1) / (n + 1)) - 1);
+        const double chiN = std::sqrt(n) *
+                (1 - 1 / (4.0 * n) + 1 / (21.0 * n * n));
+        const unsigned long eigenPeriod = std::max<unsigned long>(
+                    1, lambda / ((c1 + cmu) * n * 10));
+
+        mean_.assign(n, 0);
+        for(const auto &org : population_)
+        {
+            for(size_t j = 0; j < n; ++j) mean_[j] += org.chromosome[j];
+        }
+        for(double &value : mean_) value /= lambda;
+        sigma_ = initialSigma_;
+        covariance_.assign(n * n, 0);
+        basis_.assign(n * n, 0);
+        for(size_t j = 0; j < n; ++j)
+        {
+            covariance_[j * n + j] = 1;
+            basis_[j * n + j] = 1;
+        }
+        scales_.assign(n, 1);
+        std::vector<double> pathC(n, 0), pathSigma(n, 0);
+        std::vector<double> steps(mu * n), step(n), z(n), scaled(n);
+        std::normal_distribution<> normal(0, 1);
+        unsigned long decomposed = 0;
+
+        for(unsigned long i = 0; !this->shouldStop(i); ++i)
+        {
+            this->display(i);
+            for(auto &org : population_)
+            {
+                // x = m + sigma B D z
+                for(size_t k = 0; k < n; ++k)
+                {
+                    scaled[k] = scales_[k] * normal(gen_);
+                }
+                for(size_t j = 0; j < n; ++j)
+                {
+                    const double *row = &basis_[j * n];
+                    double value = 0;
+                    for(size_t k = 0; k < n; ++k) value += row[k] * scaled[k];
+                    org.chromosome[j] = toGene<GenType>(
+                                mean_[j] + sigma_ * value);
+                }
+            }
+            this->calcFitnessForPopulation(population_);
+            this->sortPopulation(minimize);
+            if(this->better(population_.front(), best))
+            {
+                best = population_.front();
+            }
+
+            // Steps are taken from the repaired genes
+            std::fill(step.begin(), step.end(), 0);
+            for(size_t k = 0; k < mu; ++k)
+            {
+                const auto &x = population_[k].chromosome;
+                double *y = &steps[k * n];
+                for(size_t j = 0; j < n; ++j)
+                {
+                    y[j] = (x[j] - mean_[j]) / sigma_;
+                    step[j] += weights[k] * y[j];
+                }
+            }
+            for(size_t j = 0; j < n; ++j) mean_[j] += sigma_ * step[j];
+
+            // C^(-1/2) step = B D^-1 B^T step
+            std::fill(z.begin(), z.end(), 0);
+            for(size_t j = 0; j < n; ++j)
+            {
+                const double *row = &basis_[j * n];
+                for(size_t k = 0; k < n; ++k) z[k] += row[k] * step[j];
+            }
+            for(size_t k = 0; k < n; ++k) z[k] /= scales_[k];
+            const double normS = std::sqrt(cs * (2 - cs) * mueff);
+            double length = 0;
+            for(size_t j = 0; j < n; ++j)
+            {
+                const double *row = &basis_[j * n];
+                double value = 0;
+                for(size_t k = 0; k < n; ++k) value += row[k] * z[k];
+                pathSigma[j] = (1 - cs) * pathSigma[j] + normS * value;
+                length += pathSigma[j] * pathSigma[j];
+            }
+            length = std::sqrt(length);
+            const bool hsig = length / std::sqrt(
+                        1 - std::pow(1 - cs, 2.0 * (i + 1))) / chiN <
+                    1.4 + 2.0 / (n + 1);
+            const double normC = (hsig) ? std::sqrt(cc * (2 - cc) * mueff) :
+                                          0;
+            for(size_t j = 0; j < n; ++j)
+            {
+                pathC[j] = (1 - cc) * pathC[j] + normC * step[j];
+            }
+
+            // Rank-one and rank-mu update of the upper triangle
+            const double decay = 1 - c1 - cmu +
+                    ((hsig) ? 0 : c1 * cc * (2 - cc));
+            for(size_t j = 0; j < n; ++j)
+            {
+                double *row = &covariance_[j * n];
+                const double rankOne = c1 * pathC[j];
+                for(size_t l = j; l < n; ++l)
+                {
+                    row[l] = decay * row[l] + rankOne * pathC[l];
+                }
+                for(size_t k = 0; k < mu; ++k)
+                {
+                    const double *y = &steps[k * n];
+                    const double factor = cmu * weights[k] * y[j];
+                    for(size_t l = j; l < n; ++l) row[l] += factor * y[l];
+                }
+            }
+
+            sigma_ *= std::exp(cs / damps * (length / chiN - 1));
+            if(i + 1 - decomposed >= eigenPeriod)
+            {
+                decompose();
+                decomposed = i + 1;
+            }
+            this->updateStatistics(i + 1, minimize);
+        }
+
+        return best;
+    }
+
+    double sigma() const
+    {
+        return sigma_;
+    }
+
+    const std::vector<double> &mean() const
+    {
+        return mean_;
+    }
+
+private:
+    const double initialSigma_;
+    double sigma_;
+    std::mt19937_64 gen_;
+    std::vector<double> mean_;
+    std::vector<double> covariance_;
+    // Eigenvectors are the columns of the row-major basis
+    std::vector<double> basis_;
+    // Square roots of the eigenvalues
+    std::vector<double> scales_;
+
+    static size_t defaultPopulationSize(size_t chromosomeSize)
+    {
+        return 4 + static_cast<size_t>(3 * std::log(std::max<size_t>(
+                                                        chromosomeSize, 1)));
+    }
+
+    void decompose()
+    {
+        const size_t n = scales_.size();
+        for(double value : covariance_)
+        {
+            if(!std::isfinite(value)) return;
+        }
+        auto &v = basis_;
+        for(size_t j = 0; j < n; ++j)
+        {
+            for(size_t l = j; l < n; ++l)
+            {
+                v[j * n + l] = v[l * n + j] = covariance_[j * n + l];
+            }
+        }
+        std::vector<double> d(n), e(n);
+        tridiagonalize(v, d, e);
+        diagonalize(v, d, e);
+        for(size_t k = 0; k < n; ++k)
+        {
+            scales_[k] = std::sqrt(std::max(d[k], 1e-20));
+        }
+    }
+
+    // Householder reduction of the symmetric matrix v to tridiagonal form
+    // (tred2 from EISPACK), v becomes the accumulated transformation
+    void tridiagonalize(std::vector<double> &v, std::vector<double> &d,
+                        std::vector<double> &e) const
+    {
+        const size_t n = d.size();
+        auto at = [&](size_t row, size_t column) -> double & {
+            return v[row * n + column];
+        };
+        for(size_t j = 0; j < n; ++j) d[j] = at(n - 1, j);
+        for(size_t i = n - 1; i > 0; --i)
+        {
+            double scale = 0, h = 0;
+            for(size_t k = 0; k < i; ++k) scale += std::fabs(d[k]);
+            if(scale == 0)
+            {
+                e[i] = d[i - 1];
+                for(size_t j = 0; j < i; ++j)
+                {
+                    d[j] = at(i - 1, j);
+                    at(i, j) = 0;
+                    at(j, i) = 0;
+                }
+            }
+            else
+            {
+                for(size_t k = 0; k < i; ++k)
+                {
+                    d[k] /= scale;
+                    h += d[k] * d[k];
+                }
+                double f = d[i - 1];
+                double g = (f > 0) ? -std::sqrt(h) : std::sqrt(h);
+                e[i] = scale * g;
+                h -= f * g;
+                d[i - 1] = f - g;
+                for(size_t j = 0; j < i; ++j) e[j] = 0;
+                for(size_t j = 0; j < i; ++j)
+                {
+                    f = d[j];
+                    at(j, i) = f;
+                    g = e[j] + at(j, j) * f;
+                    for(size_t k = j + 1; k < i; ++k)
+                    {
+                        g += at(k, j) * d[k];
+                        e[k] += at(k, j) * f;
+                    }
+                    e[j] = g;
+                }
+                f = 0;
+                for(size_t j = 0; j < i; ++j)
+                {
+                    e[j] /= h;
+                    f += e[j] * d[j];
+                }
+                const double hh = f / (h + h);
+                for(size_t j = 0; j < i; ++j) e[j] -= hh * d[j];
+                for(size_t j = 0; j < i; ++j)
+                {
+                    f = d[j];
+                    g = e[j];
+                    for(size_t k = j; k < i; ++k)
+                    {
+                        at(k, j) -= f * e[k] + g * d[k];
+                    }
+                    d[j] = at(i - 1, j);
+                    at(i, j) = 0;
+                }
+            }
+            d[i] = h;
+        }
+        for(size_t i = 0; i + 1 < n; ++i)
+        {
+            at(n - 1, i) = at(i, i);
+            at(i, i) = 1;
+            const double h = d[i + 1];
+            if(h != 0)
+            {
+                for(size_t k = 0; k <= i; ++k) d[k] = at(k, i + 1) / h;
+                for(size_t j = 0; j <= i; ++j)
+                {
+                    double g = 0;
+                    for(size_t k = 0; k <= i; ++k)
+                    {
+                        g += at(k, i + 1) * at(k, j);
+                    }
+                    for(size_t k = 0; k <= i; ++k) at(k, j) -= g * d[k];
+                }
+            }
+            for(size_t k = 0; k <= i; ++k) at(k, i + 1) = 0;
+        }
+        for(size_t j = 0; j < n; ++j)
+        {
+            d[j] = at(n - 1, j);
+            at(n - 1, j) = 0;
+        }
+        at(n - 1, n - 1) = 1;
+        e[0] = 0;
+    }
+
+    // Implicit QL iterations on the tridiagonal matrix (tql2 from EISPACK)
+    void diagonalize(std::vector<double> &v, std::vector<double> &d,
+                     std::vector<double> &e) const
+    {
+        const size_t n = d.size();
+        auto at = [&](size_t row, size_t column) -> double & {
+            return v[row * n + column];
+        };
+        for(size_t i = 1; i < n; ++i) e[i - 1] = e[i];
+        e[n - 1] = 0;
+        const double eps = std::numeric_limits<double>::epsilon();
+        double f = 0, tst1 = 0;
+        for(size_t l = 0; l < n; ++l)
+        {
+            tst1 = std::max(tst1, std::fabs(d[l]) + std::fabs(e[l]));
+            size_t m = l;
+            while(m < n - 1 && std::fabs(e[m]) > eps * tst1) ++m;
+            if(m > l)
+            {
+                // Bounded in case of a degenerate matrix
+                for(size_t iteration = 0; iteration < 30 &&
+                    std::fabs(e[l]) > eps * tst1; ++iteration)
+                {
+                    double g = d[l];
+                    double p = (d[l + 1] - g) / (2 * e[l]);
+                    double r = std::hypot(p, 1.0);
+                    if(p < 0) r = -r;
+                    d[l] = e[l] / (p + r);
+                    d[l + 1] = e[l] * (p + r);
+                    const double dl1 = d[l + 1];
+                    double h = g - d[l];
+                    for(size_t i = l + 2; i < n; ++i) d[i] -= h;
+                    f += h;
+
+                    p = d[m];
+                    double c = 1, c2 = 1, c3 = 1, s = 0, s2 = 0;
+                    const double el1 = e[l + 1];
+                    for(size_t i = m; i-- > l;)
+                    {
+                        c3 = c2;
+                        c2 = c;
+                        s2 = s;
+                        g = c * e[i];
+                        h = c * p;
+                        r = std::hypot(p, e[i]);
+                        e[i + 1] = s * r;
+                        s = e[i] / r;
+                        c = p / r;
+                        p = c * d[i] - s * g;
+                        d[i + 1] = h + s * (c * g + s * d[i]);
+                        for(size_t k = 0; k < n; ++k)
+                        {
+                            h = at(k, i + 1);
+                            at(k, i + 1) = s * at(k, i) + c * h;
+                            at(k, i) = c * at(k, i) - s * h;
+                        }
+                    }
+                    p = -s * s2 * c3 * el1 * e[l] / dl1;
+                    e[l] = s * p;
+                    d[l] = c * p;
+                }
+            }
+            d[l] += f;
+            e[l] = 0;
+        }
+    }
+};
+
+}
+
+#endif // CMAES_H
@@ -0,0 +1,325 @@
+#ifndef CONSTRAINTS_H
+#define CONSTRAINTS_H
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "organism.h"
+#include "fitnesscaling.h"
+#include "geneticalgorithm.h"
+
+namespace ga
+{
+
+// Returns the amount of violation, values <= 0 mean the constraint holds
+template<typename GenType>
+using Constraint = std::function<double(const std::vector<GenType> &)>;
+
+// Moves genes back inside [lower, upper]. Bound vectors may be shorter than
+// the chromosome, the remaining genes are left unbounded. All strategies
+// are written as straight select/arithmetic loops so that the compiler can
+// vectorize them.
+template<typename GenType>
+class BoundRepair
+{
+public:
+    virtual void repair(std::vector<GenType> &,
+                        const std::vector<GenType> &lower,
+                        const std::vector<GenType> &upper) = 0;
+    virtual ~BoundRepair() = default;
+};
+
+template<typename GenType>
+class ClampRepair : public BoundRepair<GenType>
+{
+public:
+    void repair(std::vector<GenType> &chromosome,
+                const std::vector<GenType> &lower,
+                const std::vector<GenType> &upper) override
+    {
+        const size_t both = std::min(lower.size(), upper.size());
+        for(size_t i = 0; i < both; ++i)
+        {
+            const GenType gen = chromosome[i];
+            chromosome[i] = std::min<GenType>(std::max<GenType>(gen, lower[i]),
+                                              upper[i]);
+        }
+        for(size_t i = both; i < lower.size(); ++i)
+        {
+            chromosome[i] = std::max<GenType>(chromosome[i], lower[i]);
+        }
+        for(size_t i = both; i < upper.size(); ++i)
+        {
+            chromosome[i] = std::min<GenType>(chromosome[i], upper[i]);
+        }
+    }
+};
+
+// Mirrors genes at the violated bound (periodically for far outliers)
+template<typename GenType>
+class ReflectRepair : public BoundRepair<GenType>
+{
+public:
+    ReflectRepair()
+    {
+        static_assert(!std::is_same<GenType, bool>::value,
+                      "ReflectRepair doesn't work with binary encoding!");
+    }
+    void repair(std::vector<GenType> &chromosome,
+                const std::vector<GenType> &lower,
+                const std::vector<GenType> &upper) override
+    {
+        const size_t both = std::min(lower.size(), upper.size());
+        for(size_t i = 0; i < both; ++i)
+        {
+            const double low = lower[i];
+            const double range = static_cast<double>(upper[i]) - low;
+            const double period = 2 * range;
+            const double offset = static_cast<double>(chromosome[i]) - low;
+            const double folded = (period > 0) ?
+                        offset - period * std::floor(offset / period) : 0;
+            const double reflected = (folded > range) ? period - folded :
+                                                         folded;
+            const bool inside = offset >= 0 && offset <= range;
+            chromosome[i] = (inside) ? chromosome[i] :
+                                       static_cast<GenType>(low + reflected);
+        }
+        ClampRepair<GenType>().repair(chromosome, lower, upper);
+    }
+};
+
+// Treats every bounded gene as periodic
+template<typename GenType>
+class WrapRepair : public BoundRepair<GenType>
+{
+public:
+    WrapRepair()
+    {
+        static_assert(!std::is_same<GenType, bool>::value,
+                      "WrapRepair doesn't work with binary encoding!");
+    }
+    void repair(std::vector<GenType> &chromosome,
+                const std::vector<GenType> &lower,
+                const std::vector<GenType> &upper) override
+    {
+        const size_t both = std::min(lower.size(), upper.size());
+        for(size_t i = 0; i < both; ++i)
+        {
+            const double low = lower[i];
+            const double range = static_cast<double>(upper[i]) - low;
+            const double offset = static_cast<double>(chromosome[i]) - low;
+            const double wrapped = (range > 0) ?
+                        offset - range * std::floor(offset / range) : 0;
+            const bool inside = offset >= 0 && offset <= range;
+            chromosome[i] = (inside) ? chromosome[i] :
+                                       static_cast<GenType>(low + wrapped);
+        }
+        ClampRepair<GenType>().repair(chromosome, lower, upper);
+    }
+};
+
+// Draws violating genes uniformly inside their bounds
+template<typename GenType>
+class ResampleRepair : public BoundRepair<GenType>
+{
+public:
+    ResampleRepair()
+    {
+        static_assert(!std::is_same<GenType, bool>::value,
+                      "ResampleRepair doesn't work with binary encoding!");
+    }
+    void repair(std::vector<GenType> &chromosome,
+                const std::vector<GenType> &lower,
+                const std::vector<GenType> &upper) override
+    {
+        // Called from the evaluation threads
+        thread_local std::mt19937_64 gen(std::random_device{}());
+        std::uniform_real_distribution<> distribution(0, 1);
+        const size_t both = std::min(lower.size(), upper.size());
+        for(size_t i = 0; i < both; ++i)
+        {
+            if(chromosome[i] < lower[i] || chromosome[i] > upper[i])
+            {
+                chromosome[i] = static_cast<GenType>(lower[i] +
+                        distribution(gen) * (upper[i] - lower[i]));
+            }
+        }
+        ClampRepair<GenType>().repair(chromosome, lower, upper);
+    }
+};
+
+// Assigns fitness to infeasible organisms, whose fitness function was
+// never called. Applied to every freshly evaluated batch.
+template<typename GenType>
+class ConstraintHandling
+{
+public:
+    virtual void reset() {}
+    virtual void handle(Population<GenType> &, bool minimize) = 0;
+    virtual ~ConstraintHandling() = default;
+};
+
+// Deb's feasibility rules: feasible organisms beat infeasible ones, which
+// are ordered by violation. Infeasible fitness is the worst feasible
+// fitness seen so far plus the violation.
+template<typename GenType>
+class DebRules : public ConstraintHandling<GenType>
+{
+public:
+    void reset() override
+    {
+        seen_ = false;
+    }
+    void handle(Population<GenType> &population, bool minimize) override
+    {
+        const double sign = (minimize) ? 1 : -1;
+        for(const auto &org : population)
+        {
+            if(org.violation > 0) continue;
+            if(!seen_ || sign * org.fitness > sign * worst_)
+            {
+                worst_ = org.fitness;
+                seen_ = true;
+            }
+        }
+        const double base = (seen_) ? worst_ : 0;
+        for(auto &org : population)
+        {
+            if(org.violation > 0) org.fitness = base + sign * org.violation;
+        }
+    }
+
+private:
+    bool seen_ = false;
+    double worst_ = 0;
+};
+
+// Infeasible fitness is the best feasible fitness plus a penalty which
+// grows while feasible organisms are scarcer than the target ratio and
+// shrinks otherwise, so slightly infeasible organisms may compete with
+// feasible ones near the constraint boundary.
+template<typename GenType>
+class AdaptivePenalty : public ConstraintHandling<GenType>
+{
+public:
+    AdaptivePenalty(double penalty = 1, double targetRatio = 0.5,
+                    double factor = 1.2) :
+        initialPenalty_(penalty), targetRatio_(targetRatio),
+        factor_(factor), penalty_(penalty) {}
+    void reset() override
+    {
+        penalty_ = initialPenalty_;
+        seen_ = false;
+    }
+    void handle(Population<GenType> &population, bool minimize) override
+    {
+        if(population.empty()) return;
+        const double sign = (minimize) ? 1 : -1;
+        size_t feasible = 0;
+        for(const auto &org : population)
+        {
+            if(org.violation > 0) continue;
+            ++feasible;
+            if(!seen_ || sign * org.fitness < sign * best_)
+            {
+                best_ = org.fitness;
+                seen_ = true;
+            }
+        }
+        const double ratio = static_cast<double>(feasible) /
+                population.size();
+        if(ratio < targetRatio_) penalty_ *= factor_;
+        else penalty_ /= factor_;
+        const double base = (seen_) ? best_ : 0;
+        for(auto &org : population)
+        {
+            if(org.violation > 0)
+            {
+                org.fitness = base + sign * penalty_ * (1 + org.violation);
+            }
+        }
+    }
+
+    double penalty() const { return penalty_; }
+
+private:
+    const double initialPenalty_;
+    const double targetRatio_;
+    const double factor_;
+    double penalty_;
+    bool seen_ = false;
+    double best_ = 0;
+};
+
+// Stochastic ranking (Runarsson & Yao): a bubble sort which compares
+// adjacent organisms by fitness when both are feasible and by violation
+// otherwise. With probability pf a pair involving an infeasible organism,
+// whose objective is unknown, is ordered at random instead. Fitness
+// becomes the rank.
+template<typename GenType>
+class StochasticRanking : public FitnessScaling<GenType>
+{
+public:
+    StochasticRanking(double pf = 0.45) :
+        pf_(pf), gen_(std::random_device()()) {}
+    void scale(Population<GenType> &population, bool minimize) override
+    {
+        const size_t size = population.size();
+        const double sign = (minimize) ? 1 : -1;
+        std::vector<size_t> order(size);
+        std::iota(order.begin(), order.end(), 0);
+        std::uniform_real_distribution<> distribution(0, 1);
+        for(size_t sweep = 0; sweep < size; ++sweep)
+        {
+            bool swapped = false;
+            for(size_t j = 0; j + 1 < size; ++j)
+            {
+                const auto &lhs = population[order[j]];
+                const auto &rhs = population[order[j + 1]];
+                const bool feasible = lhs.violation <= 0 &&
+                        rhs.violation <= 0;
+                bool worse;
+                if(feasible)
+                {
+                    worse = sign * lhs.fitness > sign * rhs.fitness;
+                }
+                else if(distribution(gen_) < pf_)
+                {
+                    // The objective of infeasible organisms is unknown
+                    worse = distribution(gen_) < 0.5;
+                }
+                else
+                {
+                    worse = lhs.violation > rhs.violation;
+                }
+                if(worse)
+                {
+                    std::swap(order[j], order[j + 1]);
+                    swapped = true;
+                }
+            }
+            if(!swapped) break;
+        }
+        std::vector<double> rank(size);
+        for(size_t i = 0; i < size; ++i)
+        {
+            rank[order[i]] = (minimize) ? i : size - i - 1;
+        }
+        for(size_t i = 0; i < size; ++i)
+        {
+            population[i].fitness = rank[i];
+        }
+    }
+
+private:
+    const double pf_;
+    std::mt19937_64 gen_;
+};
+
+}
+
+#endif // CONSTRAINTS_H
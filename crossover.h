@@ -4,6 +4,7 @@
 #include <iostream>
 #include <set>
 #include "organism.h"
+#include "gene.h"
 #include "geneticalgorithm.h"
 #include <random>
 
@@ -67,9 +68,9 @@ public:
         offspring.emplace_back(lhs.chromosome.size());
         for(size_t i = 0; i < lhs.chromosome.size(); ++i)
         {
-            double alpha = distribution_(generator_);
-            offspring[0].chromosome[i] = lhs.chromosome[i] +
-                    alpha * (rhs.chromosome[i] - lhs.chromosome[i]);
+            const GeneReal<GenType> alpha = distribution_(generator_);
+            offspring[0].chromosome[i] = toGene<GenType>(lhs.chromosome[i] +
+                    alpha * (rhs.chromosome[i] - lhs.chromosome[i]));
         }
 
 
@@ -78,7 +79,7 @@ public:
 
 private:
     std::default_random_engine generator_;
-    std::normal_distribution<GenType> distribution_;
+    std::normal_distribution< GeneReal<GenType> > distribution_;
 };
 
 template<typename GenType>
@@ -97,11 +98,11 @@ public:
     {
         std::vector<Organism <GenType> > offspring;
         offspring.emplace_back(lhs.chromosome.size());
-        double alpha = distribution_(generator_);
+        const GeneReal<GenType> alpha = distribution_(generator_);
         for(size_t i = 0; i < lhs.chromosome.size(); ++i)
         {
-            offspring[0].chromosome[i] = lhs.chromosome[i] +
-                    alpha * (rhs.chromosome[i] - lhs.chromosome[i]);
+            offspring[0].chromosome[i] = toGene<GenType>(lhs.chromosome[i] +
+                    alpha * (rhs.chromosome[i] - lhs.chromosome[i]));
         }
 
         return offspring;
@@ -109,7 +110,7 @@ public:
 
 private:
     std::default_random_engine generator_;
-    std::normal_distribution<GenType> distribution_;
+    std::normal_distribution< GeneReal<GenType> > distribution_;
 };
 
 template<typename GenType>
@@ -165,7 +166,7 @@ public:
         size_t pointIndex = 0;
         for(size_t i = 0; i < lhs.chromosome.size(); ++i)
         {
-            if(i >= points[pointIndex] && i <= points.back())
+            if(pointIndex < points.size() && i >= points[pointIndex])
             {
                 reverse = !reverse;
                 pointIndex++;
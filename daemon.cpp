@@ -0,0 +1,147 @@
+#include <iostream>
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <pthread.h>
+#include "service.h"
+
+using namespace std;
+using namespace ga;
+
+static void registerProblems(ProblemRegistry &registry)
+{
+    registry.add("sphere", [](const vector<double> &x) {
+        double sum = 0;
+        for(double value : x) sum += value * value;
+        return sum;
+    });
+    registry.add("rastrigin", [](const vector<double> &x) {
+        double sum = 10 * x.size();
+        for(double value : x)
+        {
+            sum += value * value - 10 * cos(2 * M_PI * value);
+        }
+        return sum;
+    });
+    registry.add("rosenbrock", [](const vector<double> &x) {
+        double sum = 0;
+        for(size_t i = 0; i + 1 < x.size(); ++i)
+        {
+            sum += 100 * pow(x[i + 1] - x[i] * x[i], 2) + pow(1 - x[i], 2);
+        }
+        return sum;
+    });
+    registry.add("ackley", [](const vector<double> &x) {
+        double squares = 0, cosines = 0;
+        for(double value : x)
+        {
+            squares += value * value;
+            cosines += cos(2 * M_PI * value);
+        }
+        return -20 * exp(-0.2 * sqrt(squares / x.size())) -
+                exp(cosines / x.size()) + 20 + M_E;
+    });
+    // Two dimensional problems of main.cpp
+    registry.add("mishra-bird", [](const vector<double> &x) {
+        if(x.size() < 2) return 0.0;
+        return sin(x[1]) * exp(pow(1 - cos(x[0]), 2)) + cos(x[0]) *
+                exp(pow(1 - sin(x[1]), 2)) + pow(x[0] - x[1], 2);
+    });
+    registry.add("easom", [](const vector<double> &x) {
+        if(x.size() < 2) return 0.0;
+        return -cos(x[0]) * cos(x[1]) * exp(-(pow(x[0] - M_PI, 2) +
+                                              pow(x[1] - M_PI, 2)));
+    });
+}
+
+static int serve(const string &path, unsigned int workers)
+{
+    // Signals are taken by a dedicated thread
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    ProblemRegistry registry;
+    registerProblems(registry);
+    Scheduler scheduler(workers);
+    OptimizationServer server(registry, scheduler);
+    if(!server.listen(path))
+    {
+        cerr << "Can't listen on " << path << endl;
+        return 1;
+    }
+    thread waiter([&]() {
+        int signal;
+        sigwait(&signals, &signal);
+        server.stop();
+    });
+    cout << "Serving on " << path << " with " << scheduler.workers() <<
+            " workers" << endl;
+    server.run();
+    // Wakes the waiter if the server stopped on its own
+    pthread_kill(waiter.native_handle(), SIGTERM);
+    waiter.join();
+    return 0;
+}
+
+static int run(int argc, char *argv[])
+{
+    OptimizationRequest request;
+    request.id = 1;
+    request.problem = argv[2];
+    const size_t dimensions = stoul(argv[3]);
+    request.lower.assign(dimensions, stod(argv[4]));
+    request.upper.assign(dimensions, stod(argv[5]));
+    request.maxGenerations = 2000;
+    request.progressPeriod = 100;
+    const string path = (argc > 6) ? argv[6] : "/tmp/genetic.sock";
+
+    OptimizationClient client;
+    if(!client.connect(path))
+    {
+        cerr << "Can't connect to " << path << endl;
+        return 1;
+    }
+    OptimizationResult result;
+    const bool done = client.optimize(request, result,
+                                      [](const OptimizationProgress &p) {
+        cout << "Iteration #" << p.generation << " Best: " << p.best <<
+                " Mean: " << p.mean << " Evaluations: " << p.evaluations <<
+                endl;
+    });
+    if(!done || result.status != OptimizationStatus::Finished)
+    {
+        cerr << "Request failed" << endl;
+        return 1;
+    }
+    cout << "Result:";
+    for(double value : result.chromosome) cout << " " << value;
+    cout << " Fit: " << result.fitness << " Evaluations: " <<
+            result.evaluations << endl;
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const string command = (argc > 1) ? argv[1] : "";
+    if(command == "serve")
+    {
+        const string path = (argc > 2) ? argv[2] : "/tmp/genetic.sock";
+        const unsigned int workers = (argc > 3) ?
+                    stoul(argv[3]) : thread::hardware_concurrency();
+        return serve(path, workers);
+    }
+    if(command == "run" && argc > 5)
+    {
+        return run(argc, argv);
+    }
+    cerr << "Usage:" << endl <<
+            "  " << argv[0] << " serve [socket] [workers]" << endl <<
+            "  " << argv[0] <<
+            " run problem dimensions lower upper [socket]" << endl;
+    return 2;
+}
@@ -0,0 +1,265 @@
+#ifndef DECODING_H
+#define DECODING_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "organism.h"
+#include "gene.h"
+
+namespace ga
+{
+
+enum class BinaryCode
+{
+    Plain,
+    // Neighboring values differ in a single bit, so that a one bit
+    // mutation can always reach them
+    Gray
+};
+
+// Direct-mapped cache of decoded parameters, shared by the evaluation
+// threads. Elites and duplicate organisms then cost a lookup instead of a
+// decoding. Chromosomes are identified by their size and a 128-bit
+// fingerprint, the hashes of their genes and of the flipped genes, as the
+// standard library hashes and flips vector<bool> a word at a time but
+// compares it one bit at a time.
+class DecodingCache
+{
+public:
+    struct Key
+    {
+        size_t size;
+        size_t hash;
+        size_t check;
+
+        bool operator==(const Key &other) const
+        {
+            return size == other.size && hash == other.hash &&
+                    check == other.check;
+        }
+    };
+
+    explicit DecodingCache(size_t size) : slots_(std::max<size_t>(size, 1))
+    {
+    }
+
+    static Key key(const std::vector<bool> &chromosome)
+    {
+        // Per thread and reused, as evaluations run in parallel
+        thread_local std::vector<bool> flipped;
+        flipped = chromosome;
+        flipped.flip();
+        const std::hash< std::vector<bool> > hash;
+        return {chromosome.size(), hash(chromosome), hash(flipped)};
+    }
+
+    bool find(const Key &key, std::vector<double> &values)
+    {
+        const size_t index = key.hash % slots_.size();
+        const Slot &slot = slots_[index];
+        std::lock_guard<std::mutex> lock(locks_[index % locks_.size()]);
+        if(!slot.used || !(slot.key == key)) return false;
+        values.assign(slot.values.begin(), slot.values.end());
+        return true;
+    }
+
+    void store(const Key &key, const std::vector<double> &values)
+    {
+        const size_t index = key.hash % slots_.size();
+        Slot &slot = slots_[index];
+        std::lock_guard<std::mutex> lock(locks_[index % locks_.size()]);
+        slot.used = true;
+        slot.key = key;
+        slot.values.assign(values.begin(), values.end());
+    }
+
+private:
+    struct Slot
+    {
+        bool used = false;
+        Key key;
+        std::vector<double> values;
+    };
+
+    std::vector<Slot> slots_;
+    // Striped, so that threads rarely wait for each other
+    std::array<std::mutex, 64> locks_;
+};
+
+// Decodes binary chromosomes into parameters: the chromosome is split into
+// fixed-width fields, the first gene of a field being its most significant
+// bit, and each field is mapped onto an integer or real range. Gray code
+// is undone with a logarithmic shift/xor cascade.
+class BinaryDecoder
+{
+public:
+    explicit BinaryDecoder(BinaryCode code = BinaryCode::Gray) :
+        code_(code) {}
+
+    // count fields of bits (at most 64) genes mapped linearly onto
+    // [lower, upper]
+    BinaryDecoder &addReal(unsigned int bits, double lower, double upper,
+                           size_t count = 1)
+    {
+        bits = std::min(std::max(bits, 1u), 64u);
+        const double levels = std::ldexp(1.0, bits) - 1;
+        for(size_t i = 0; i < count; ++i)
+        {
+            fields_.push_back({length_, bits, lower,
+                               (upper - lower) / levels});
+            length_ += bits;
+        }
+        return *this;
+    }
+
+    // count fields of bits genes holding lower, lower + 1, ...
+    // lower + 2^bits - 1
+    BinaryDecoder &addInteger(unsigned int bits, long long lower = 0,
+                              size_t count = 1)
+    {
+        bits = std::min(std::max(bits, 1u), 64u);
+        for(size_t i = 0; i < count; ++i)
+        {
+            fields_.push_back({length_, bits,
+                               static_cast<double>(lower), 1});
+            length_ += bits;
+        }
+        return *this;
+    }
+
+    // Number of parameters
+    size_t size() const
+    {
+        return fields_.size();
+    }
+
+    // Number of genes the chromosome needs
+    size_t length() const
+    {
+        return length_;
+    }
+
+    // Unsigned value of a field after undoing the Gray code
+    uint64_t value(const std::vector<bool> &chromosome, size_t i) const
+    {
+        const Field &field = fields_[i];
+        uint64_t value = extract(chromosome, field.offset, field.bits);
+        if(code_ == BinaryCode::Gray)
+        {
+            for(unsigned int shift = 1; shift < field.bits; shift <<= 1)
+            {
+                value ^= value >> shift;
+            }
+        }
+        return value;
+    }
+
+    double decode(const std::vector<bool> &chromosome, size_t i) const
+    {
+        return fields_[i].lower + fields_[i].step *
+                static_cast<double>(value(chromosome, i));
+    }
+
+    void decode(const std::vector<bool> &chromosome,
+                std::vector<double> &values) const
+    {
+        values.resize(fields_.size());
+        for(size_t i = 0; i < fields_.size(); ++i)
+        {
+            values[i] = decode(chromosome, i);
+        }
+    }
+
+    std::vector<double> decode(const std::vector<bool> &chromosome) const
+    {
+        std::vector<double> values;
+        decode(chromosome, values);
+        return values;
+    }
+
+    // Nearest representable chromosome, e.g. to seed a population
+    std::vector<bool> encode(const std::vector<double> &values) const
+    {
+        std::vector<bool> chromosome(length_);
+        for(size_t i = 0; i < fields_.size() && i < values.size(); ++i)
+        {
+            const Field &field = fields_[i];
+            const double top = std::ldexp(1.0, field.bits) - 1;
+            double level = (field.step > 0) ?
+                        std::round((values[i] - field.lower) / field.step) :
+                        0;
+            level = std::min(std::max(level, 0.0), top);
+            uint64_t value = (level >= std::ldexp(1.0, 63)) ?
+                        ~uint64_t(0) >> (64 - field.bits) :
+                        static_cast<uint64_t>(level);
+            if(code_ == BinaryCode::Gray) value ^= value >> 1;
+            for(unsigned int j = 0; j < field.bits; ++j)
+            {
+                chromosome[field.offset + j] =
+                        (value >> (field.bits - 1 - j)) & 1;
+            }
+        }
+        return chromosome;
+    }
+
+    // Fitness function of the binary genes, which sees the decoded
+    // parameters. The parameters of up to cacheSize chromosomes are
+    // cached, zero disables the cache.
+    std::function<void(Organism<bool> &)>
+    fitness(std::function<void(Organism<double> &)> function,
+            size_t cacheSize = 1024) const
+    {
+        const BinaryDecoder decoder = *this;
+        const std::shared_ptr<DecodingCache> cache = (cacheSize) ?
+                    std::make_shared<DecodingCache>(cacheSize) : nullptr;
+        return decodedFitness<bool>(
+                    [decoder, cache](const std::vector<bool> &chromosome,
+                                     std::vector<double> &values) {
+            if(!cache)
+            {
+                decoder.decode(chromosome, values);
+                return;
+            }
+            const DecodingCache::Key key = DecodingCache::key(chromosome);
+            if(cache->find(key, values)) return;
+            decoder.decode(chromosome, values);
+            cache->store(key, values);
+        }, std::move(function));
+    }
+
+private:
+    struct Field
+    {
+        size_t offset;
+        unsigned int bits;
+        double lower;
+        double step;
+    };
+
+    BinaryCode code_;
+    std::vector<Field> fields_;
+    size_t length_ = 0;
+
+    // Bits [offset, offset + bits) with the first one most significant
+    static uint64_t extract(const std::vector<bool> &chromosome,
+                            size_t offset, unsigned int bits)
+    {
+        uint64_t value = 0;
+        auto gene = chromosome.begin() + offset;
+        for(unsigned int j = 0; j < bits; ++j, ++gene)
+        {
+            value = (value << 1) | static_cast<uint64_t>(*gene);
+        }
+        return value;
+    }
+};
+
+}
+
+#endif // DECODING_H
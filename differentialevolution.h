@@ -0,0 +1,258 @@
+#ifndef DIFFERENTIALEVOLUTION_H
+#define DIFFERENTIALEVOLUTION_H
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "organism.h"
+#include "gene.h"
+#include "geneticalgorithm.h"
+#include "evolutionaryalgorithm.h"
+
+namespace ga
+{
+
+enum class DifferentialStrategy
+{
+    Rand1Bin,           // v = x_r1 + F (x_r2 - x_r3)
+    Best2Bin,           // v = x_best + F (x_r1 - x_r2 + x_r3 - x_r4)
+    CurrentToPBest1Bin  // v = x_i + F (x_pbest - x_i + x_r1 - x_r2)
+};
+
+template<typename GenType>
+class DifferentialEvolution : public EvolutionaryAlgorithm<GenType>
+{
+    using Base = EvolutionaryAlgorithm<GenType>;
+    using Base::population_;
+    using Base::initialization_;
+
+public:
+    DifferentialEvolution(size_t chromosomeSize, size_t populationSize = 50,
+                          DifferentialStrategy strategy =
+            DifferentialStrategy::Rand1Bin,
+                          double weight = 0.5, double crossoverRate = 0.9) :
+        // Mutants need distinct organisms besides the target
+        Base(chromosomeSize,
+             std::max(populationSize, minimumPopulation(strategy))),
+        strategy_(strategy),
+        weight_(weight),
+        crossoverRate_(crossoverRate),
+        adaptive_(false),
+        learningRate_(0.1),
+        greediness_(0.05),
+        gen_(std::random_device()())
+    {
+        static_assert(!std::is_same<GenType, bool>::value,
+                "DifferentialEvolution doesn't work with binary encoding!");
+    }
+
+    // JADE: every organism draws its own F and CR around means which
+    // follow the successful values; current-to-pbest/1 also draws from an
+    // archive of replaced parents
+    void setAdaptive(bool adaptive, double learningRate = 0.1,
+                     double greediness = 0.05)
+    {
+        adaptive_ = adaptive;
+        learningRate_ = learningRate;
+        greediness_ = greediness;
+    }
+
+    Organism<GenType> optimize(bool minimize = true,
+                               unsigned int numberOfThreads = 1)
+    {
+        this->start(minimize, numberOfThreads);
+        initialization_->initialize(population_);
+        this->calcFitnessForPopulation(population_);
+        this->updateStatistics(0, minimize);
+        archive_.clear();
+        double meanWeight = weight_;
+        double meanCrossoverRate = crossoverRate_;
+        Population<GenType> trials(population_.size(),
+                                   population_.front());
+        std::vector<double> weights(population_.size());
+        std::vector<double> rates(population_.size());
+        for(unsigned long i = 0; !this->shouldStop(i); ++i)
+        {
+            this->sortPopulation(minimize);
+            this->display(i);
+            for(size_t j = 0; j < population_.size(); ++j)
+            {
+                weights[j] = (adaptive_) ? sampleWeight(meanWeight) :
+                                           weight_;
+                rates[j] = (adaptive_) ?
+                            sampleCrossoverRate(meanCrossoverRate) :
+                            crossoverRate_;
+                makeTrial(j, weights[j], rates[j], trials[j]);
+            }
+            this->calcFitnessForPopulation(trials);
+
+            std::vector<double> goodWeights, goodRates;
+            for(size_t j = 0; j < population_.size(); ++j)
+            {
+                if(this->better(population_[j], trials[j])) continue;
+                if(this->better(trials[j], population_[j]))
+                {
+                    goodWeights.push_back(weights[j]);
+                    goodRates.push_back(rates[j]);
+                    if(adaptive_) archive(population_[j]);
+                }
+                std::swap(population_[j], trials[j]);
+            }
+            if(adaptive_ && !goodWeights.empty())
+            {
+                double sum = 0, squares = 0, rateSum = 0;
+                for(size_t k = 0; k < goodWeights.size(); ++k)
+                {
+                    sum += goodWeights[k];
+                    squares += goodWeights[k] * goodWeights[k];
+                    rateSum += goodRates[k];
+                }
+                // Lehmer mean favours larger successful weights
+                meanWeight += learningRate_ * (squares / sum - meanWeight);
+                meanCrossoverRate += learningRate_ *
+                        (rateSum / goodRates.size() - meanCrossoverRate);
+            }
+            this->updateStatistics(i + 1, minimize);
+        }
+        this->sortPopulation(minimize);
+
+        return population_.front();
+    }
+
+private:
+    const DifferentialStrategy strategy_;
+    const double weight_;
+    const double crossoverRate_;
+    bool adaptive_;
+    double learningRate_;
+    double greediness_;
+    std::mt19937_64 gen_;
+    Population<GenType> archive_;
+
+    static size_t minimumPopulation(DifferentialStrategy strategy)
+    {
+        switch(strategy)
+        {
+        case DifferentialStrategy::Rand1Bin:
+            return 4;
+        case DifferentialStrategy::Best2Bin:
+            return 6;
+        case DifferentialStrategy::CurrentToPBest1Bin:
+            return 3;
+        }
+        return 6;
+    }
+
+    size_t randomIndex(size_t size)
+    {
+        return std::uniform_int_distribution<size_t>(0, size - 1)(gen_);
+    }
+
+    // Index different from all of the excluded ones
+    size_t pick(std::initializer_list<size_t> excluded, size_t size)
+    {
+        while(true)
+        {
+            const size_t index = randomIndex(size);
+            if(std::find(excluded.begin(), excluded.end(), index) ==
+               excluded.end())
+            {
+                return index;
+            }
+        }
+    }
+
+    double sampleWeight(double mean)
+    {
+        std::cauchy_distribution<> distribution(mean, 0.1);
+        double weight = 0;
+        while(weight <= 0) weight = distribution(gen_);
+        return std::min(weight, 1.0);
+    }
+
+    double sampleCrossoverRate(double mean)
+    {
+        std::normal_distribution<> distribution(mean, 0.1);
+        return std::min(std::max(distribution(gen_), 0.0), 1.0);
+    }
+
+    void archive(const Organism<GenType> &org)
+    {
+        if(archive_.size() < population_.size()) archive_.push_back(org);
+        else archive_[randomIndex(archive_.size())] = org;
+    }
+
+    // Expects a sorted population
+    void makeTrial(size_t target, double weight, double rate,
+                   Organism<GenType> &trial)
+    {
+        const size_t size = population_.size();
+        const auto &x = population_[target].chromosome;
+        const size_t length = x.size();
+        std::vector<double> donor(length);
+        switch(strategy_)
+        {
+        case DifferentialStrategy::Rand1Bin:
+        {
+            const size_t r1 = pick({target}, size);
+            const size_t r2 = pick({target, r1}, size);
+            const size_t r3 = pick({target, r1, r2}, size);
+            const auto &a = population_[r1].chromosome;
+            const auto &b = population_[r2].chromosome;
+            const auto &c = population_[r3].chromosome;
+            for(size_t k = 0; k < length; ++k)
+            {
+                donor[k] = a[k] + weight * (b[k] - c[k]);
+            }
+            break;
+        }
+        case DifferentialStrategy::Best2Bin:
+        {
+            const size_t r1 = pick({target, 0}, size);
+            const size_t r2 = pick({target, 0, r1}, size);
+            const size_t r3 = pick({target, 0, r1, r2}, size);
+            const size_t r4 = pick({target, 0, r1, r2, r3}, size);
+            const auto &best = population_.front().chromosome;
+            const auto &a = population_[r1].chromosome;
+            const auto &b = population_[r2].chromosome;
+            const auto &c = population_[r3].chromosome;
+            const auto &d = population_[r4].chromosome;
+            for(size_t k = 0; k < length; ++k)
+            {
+                donor[k] = best[k] + weight * (a[k] - b[k] + c[k] - d[k]);
+            }
+            break;
+        }
+        case DifferentialStrategy::CurrentToPBest1Bin:
+        {
+            const size_t top = std::max<size_t>(
+                        1, static_cast<size_t>(greediness_ * size));
+            const auto &best = population_[randomIndex(top)].chromosome;
+            const size_t r1 = pick({target}, size);
+            // The second difference vector may come from the archive
+            const size_t r2 = pick({target, r1}, size + archive_.size());
+            const auto &a = population_[r1].chromosome;
+            const auto &b = (r2 < size) ?
+                        population_[r2].chromosome :
+                        archive_[r2 - size].chromosome;
+            for(size_t k = 0; k < length; ++k)
+            {
+                donor[k] = x[k] + weight * (best[k] - x[k] + a[k] - b[k]);
+            }
+            break;
+        }
+        }
+        const size_t forced = randomIndex(length);
+        std::uniform_real_distribution<> distribution(0, 1);
+        for(size_t k = 0; k < length; ++k)
+        {
+            trial.chromosome[k] = (k == forced || distribution(gen_) < rate) ?
+                        toGene<GenType>(donor[k]) : x[k];
+        }
+    }
+};
+
+}
+
+#endif // DIFFERENTIALEVOLUTION_H
@@ -4,6 +4,7 @@
 #include <vector>
 #include <iostream>
 #include "organism.h"
+#include "statistics.h"
 #include "geneticalgorithm.h"
 
 namespace ga
@@ -13,6 +14,8 @@ template<typename GenType>
 class Display
 {
 public:
+    // Called once per generation before display()
+    virtual void update(const Statistics &) {}
     virtual void display(const Population<GenType> &, unsigned long) = 0;
     virtual ~Display() = default;
 };
@@ -48,6 +51,28 @@ public:
     }
 };
 
+template<typename GenType>
+class StatisticsDisplay : public Display<GenType>
+{
+public:
+    void update(const Statistics &statistics) override
+    {
+        statistics_ = statistics;
+    }
+    void display(const Population<GenType> &, unsigned long iter) override
+    {
+        std::cout << "Iteration #" << iter <<
+                     " Best: " << statistics_.best <<
+                     " Mean: " << statistics_.mean <<
+                     " Diversity: " << statistics_.diversity <<
+                     " Entropy: " << statistics_.entropy <<
+                     " Evaluations: " << statistics_.evaluations << std::endl;
+    }
+
+private:
+    Statistics statistics_;
+};
+
 }
 
 #endif // DISPLAY_H
@@ -0,0 +1,203 @@
+#ifndef DIVERSITY_H
+#define DIVERSITY_H
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include "organism.h"
+
+namespace ga
+{
+
+// Running per-gene mean and variance (Welford) which is updated in O(L)
+// whenever an organism enters or leaves the population
+template<typename GenType>
+class DiversityTracker
+{
+public:
+    void reset(size_t chromosomeSize)
+    {
+        count_ = 0;
+        means_.assign(chromosomeSize, 0);
+        squares_.assign(chromosomeSize, 0);
+    }
+
+    void rebuild(const Population<GenType> &population)
+    {
+        reset(population.empty() ? 0 : population.front().chromosome.size());
+        for(const auto &org : population) add(org.chromosome);
+    }
+
+    void add(const std::vector<GenType> &chromosome)
+    {
+        ++count_;
+        for(size_t i = 0; i < means_.size(); ++i)
+        {
+            const double gen = static_cast<double>(chromosome[i]);
+            const double delta = gen - means_[i];
+            means_[i] += delta / count_;
+            squares_[i] += delta * (gen - means_[i]);
+        }
+    }
+
+    void remove(const std::vector<GenType> &chromosome)
+    {
+        if(count_ <= 1)
+        {
+            reset(means_.size());
+            return;
+        }
+        --count_;
+        for(size_t i = 0; i < means_.size(); ++i)
+        {
+            const double gen = static_cast<double>(chromosome[i]);
+            const double mean = means_[i];
+            means_[i] -= (gen - mean) / count_;
+            squares_[i] -= (gen - mean) * (gen - means_[i]);
+        }
+    }
+
+    void replace(const std::vector<GenType> &oldChromosome,
+                 const std::vector<GenType> &newChromosome)
+    {
+        remove(oldChromosome);
+        add(newChromosome);
+    }
+
+    // Mean per-gene standard deviation
+    double diversity() const
+    {
+        if(!count_ || means_.empty()) return 0;
+        double sum = 0;
+        for(size_t i = 0; i < means_.size(); ++i)
+        {
+            sum += std::sqrt(variance(i));
+        }
+        return sum / means_.size();
+    }
+
+    // Mean per-gene differential entropy under a normal approximation
+    double entropy() const
+    {
+        if(!count_ || means_.empty()) return 0;
+        const double minVariance = 1e-300;
+        double sum = 0;
+        for(size_t i = 0; i < means_.size(); ++i)
+        {
+            sum += 0.5 * std::log(2 * M_PI * M_E *
+                                  std::max(variance(i), minVariance));
+        }
+        return sum / means_.size();
+    }
+
+    double mean(size_t gen) const { return means_[gen]; }
+    double variance(size_t gen) const
+    {
+        return (count_) ? std::max(squares_[gen] / count_, 0.0) : 0;
+    }
+    size_t size() const { return count_; }
+
+private:
+    size_t count_ = 0;
+    std::vector<double> means_;
+    std::vector<double> squares_;
+};
+
+// Per-gene counts of ones for binary chromosomes
+template<>
+class DiversityTracker<bool>
+{
+public:
+    void reset(size_t chromosomeSize)
+    {
+        count_ = 0;
+        ones_.assign(chromosomeSize, 0);
+    }
+
+    void rebuild(const Population<bool> &population)
+    {
+        reset(population.empty() ? 0 : population.front().chromosome.size());
+        for(const auto &org : population) add(org.chromosome);
+    }
+
+    void add(const std::vector<bool> &chromosome)
+    {
+        ++count_;
+        for(size_t i = 0; i < ones_.size(); ++i)
+        {
+            ones_[i] += chromosome[i];
+        }
+    }
+
+    void remove(const std::vector<bool> &chromosome)
+    {
+        if(count_ <= 1)
+        {
+            reset(ones_.size());
+            return;
+        }
+        --count_;
+        for(size_t i = 0; i < ones_.size(); ++i)
+        {
+            ones_[i] -= chromosome[i];
+        }
+    }
+
+    void replace(const std::vector<bool> &oldChromosome,
+                 const std::vector<bool> &newChromosome)
+    {
+        if(!count_)
+        {
+            add(newChromosome);
+            return;
+        }
+        for(size_t i = 0; i < ones_.size(); ++i)
+        {
+            ones_[i] += newChromosome[i];
+            ones_[i] -= oldChromosome[i];
+        }
+    }
+
+    // Expected normalized Hamming distance between two random organisms
+    double diversity() const
+    {
+        if(!count_ || ones_.empty()) return 0;
+        double sum = 0;
+        for(size_t i = 0; i < ones_.size(); ++i)
+        {
+            const double p = frequency(i);
+            sum += 2 * p * (1 - p);
+        }
+        return sum / ones_.size();
+    }
+
+    // Mean per-gene Shannon entropy in bits
+    double entropy() const
+    {
+        if(!count_ || ones_.empty()) return 0;
+        double sum = 0;
+        for(size_t i = 0; i < ones_.size(); ++i)
+        {
+            const double p = frequency(i);
+            if(p > 0 && p < 1)
+            {
+                sum -= p * std::log2(p) + (1 - p) * std::log2(1 - p);
+            }
+        }
+        return sum / ones_.size();
+    }
+
+    double frequency(size_t gen) const
+    {
+        return (count_) ? static_cast<double>(ones_[gen]) / count_ : 0;
+    }
+    size_t size() const { return count_; }
+
+private:
+    size_t count_ = 0;
+    std::vector<size_t> ones_;
+};
+
+}
+
+#endif // DIVERSITY_H
@@ -0,0 +1,293 @@
+#ifndef EVOLUTIONARYALGORITHM_H
+#define EVOLUTIONARYALGORITHM_H
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "organism.h"
+#include "parallel.h"
+#include "statistics.h"
+#include "diversity.h"
+#include "initialization.h"
+#include "stoppingcriteria.h"
+#include "constraints.h"
+#include "display.h"
+
+namespace ga
+{
+
+template<typename T>
+using InitializationPtr = std::unique_ptr<Initialization<T>>;
+
+template<typename T>
+using StoppingPtr = std::unique_ptr<StoppingCriteria<T>>;
+
+template<typename T>
+using DisplayPtr = std::unique_ptr<Display<T>>;
+
+template<typename T>
+using BoundRepairPtr = std::unique_ptr<BoundRepair<T>>;
+
+template<typename T>
+using ConstraintHandlingPtr = std::unique_ptr<ConstraintHandling<T>>;
+
+// Infrastructure shared by all engines: initialization, fitness
+// evaluation with bounds and constraints, threading, statistics, stopping
+// criteria and display
+template<typename GenType>
+class EvolutionaryAlgorithm
+{
+public:
+    EvolutionaryAlgorithm(size_t chromosomeSize, size_t populationSize) :
+        initialization_(nullptr),
+        stopping_(nullptr),
+        display_(nullptr),
+        repair_(std::make_unique< ClampRepair<GenType> >()),
+        constraintHandling_(nullptr),
+        numberOfThreads_(1),
+        minimize_(true),
+        evaluations_(0)
+    {
+        for(size_t i = 0; i < populationSize; ++i)
+        {
+            population_.emplace_back(chromosomeSize);
+        }
+    }
+
+    void setInitializationAlgorithm(InitializationPtr<GenType> initialization)
+    {
+        initialization_ = std::move(initialization);
+    }
+    void setStoppingCriteria(StoppingPtr<GenType> stopping)
+    {
+        stopping_ = std::move(stopping);
+    }
+    void setFitnessFunction(std::function<void(Organism<GenType> &)> fitness)
+    {
+        fitnessFunction_ = fitness;
+    }
+    void setDisplayFunction(DisplayPtr<GenType> display)
+    {
+        display_ = std::move(display);
+    }
+
+    void setLinearBounds(std::vector<GenType> &&lower,
+                         std::vector<GenType> &&upper)
+    {
+        lowerBounds_ = std::move(lower);
+        upperBounds_ = std::move(upper);
+    }
+    // Clamping by default
+    void setBoundRepairAlgorithm(BoundRepairPtr<GenType> repair)
+    {
+        repair_ = std::move(repair);
+    }
+    // Constraints are checked before the fitness function, which is never
+    // called for infeasible organisms
+    void addConstraint(Constraint<GenType> constraint)
+    {
+        constraints_.push_back(std::move(constraint));
+    }
+    // Deb's feasibility rules by default
+    void setConstraintHandling(ConstraintHandlingPtr<GenType> handling)
+    {
+        constraintHandling_ = std::move(handling);
+    }
+
+    // Evaluation batches, local search and crowding go to the executor
+    // instead of numberOfThreads threads of the engine
+    void setExecutor(std::shared_ptr<Executor> executor)
+    {
+        executor_ = std::move(executor);
+    }
+
+    const Statistics &statistics() const
+    {
+        return statistics_;
+    }
+
+protected:
+    Population<GenType> population_;
+    InitializationPtr<GenType> initialization_;
+    StoppingPtr<GenType> stopping_;
+    DisplayPtr<GenType> display_;
+    BoundRepairPtr<GenType> repair_;
+    ConstraintHandlingPtr<GenType> constraintHandling_;
+
+    std::vector<GenType> lowerBounds_;
+    std::vector<GenType> upperBounds_;
+    std::vector< Constraint<GenType> > constraints_;
+
+    std::function<void(Organism<GenType> &)> fitnessFunction_;
+    std::shared_ptr<Executor> executor_;
+
+    unsigned int numberOfThreads_;
+    bool minimize_;
+
+    Statistics statistics_;
+    DiversityTracker<GenType> diversity_;
+    // Set by engines when all changes since the last statistics update
+    // went through trackReplacement(), which spares rebuilding the tracker
+    bool diversityTracked_ = false;
+    size_t trackedChanges_ = 0;
+    unsigned long evaluations_;
+
+    // Resets the per-run state
+    void start(bool minimize, unsigned int numberOfThreads)
+    {
+        numberOfThreads_ = numberOfThreads;
+        minimize_ = minimize;
+        evaluations_ = 0;
+        if(!constraints_.empty() && !constraintHandling_)
+        {
+            constraintHandling_ = std::make_unique< DebRules<GenType> >();
+        }
+        if(constraintHandling_) constraintHandling_->reset();
+        stopping_->reset();
+    }
+
+    bool shouldStop(unsigned long iteration)
+    {
+        stopping_->update(statistics_);
+        return stopping_->stop(iteration, population_);
+    }
+
+    void display(unsigned long iteration)
+    {
+        if(display_)
+        {
+            display_->update(statistics_);
+            display_->display(population_, iteration);
+        }
+    }
+
+    void sortPopulation(bool minimize)
+    {
+        if(minimize)
+        {
+            std::sort(population_.begin(), population_.end());
+        }
+        else
+        {
+            std::sort(population_.begin(), population_.end(),
+                      std::greater<Organism <GenType> >());
+        }
+    }
+
+    bool better(const Organism<GenType> &lhs,
+                const Organism<GenType> &rhs) const
+    {
+        return (minimize_) ? lhs.fitness < rhs.fitness :
+                             lhs.fitness > rhs.fitness;
+    }
+
+    void updateStatistics(unsigned long generation, bool minimize)
+    {
+        statistics_.generation = generation;
+        statistics_.evaluations = evaluations_;
+        collectStatistics(population_, minimize, statistics_);
+        // Incremental updates drift numerically, so the tracker is still
+        // rebuilt after as many of them as there are organisms
+        if(!diversityTracked_ || trackedChanges_ >= population_.size())
+        {
+            diversity_.rebuild(population_);
+            trackedChanges_ = 0;
+        }
+        diversityTracked_ = false;
+        statistics_.diversity = diversity_.diversity();
+        statistics_.entropy = diversity_.entropy();
+    }
+
+    // Tells the diversity tracker that added took the place of removed in
+    // the population
+    void trackReplacement(const std::vector<GenType> &removed,
+                          const std::vector<GenType> &added)
+    {
+        diversity_.replace(removed, added);
+        ++trackedChanges_;
+    }
+
+    void calcFitnessForPopulation(Population<GenType> &population)
+    {
+        evaluatePopulation(population, nullptr);
+        handleConstraints(population);
+    }
+
+    // Evaluates the organisms which aren't marked in done, if it is given
+    void evaluatePopulation(Population<GenType> &population,
+                            const std::vector<char> *done)
+    {
+        auto pending = [&](size_t i) {
+            return !done || !(*done)[i];
+        };
+        for(size_t i = 0; i < population.size(); ++i)
+        {
+            if(pending(i)) ++evaluations_;
+        }
+        auto part = [&](size_t start, size_t end) {
+            calcFitnessForPopulationPart(&population, done, start, end);
+        };
+        parallelFor(population.size(), numberOfThreads_, executor_.get(),
+                    part);
+        for(size_t i = 0; i < population.size(); ++i)
+        {
+            if(pending(i) && population[i].violation > 0) --evaluations_;
+        }
+    }
+
+    void handleConstraints(Population<GenType> &population)
+    {
+        if(constraintHandling_)
+        {
+            constraintHandling_->handle(population, minimize_);
+        }
+    }
+
+    void calcFitnessForPopulationPart(Population<GenType> *population,
+                                      const std::vector<char> *done,
+                                      size_t start, size_t end)
+    {
+        for(size_t i = start; i < end; ++i)
+        {
+            if(done && (*done)[i]) continue;
+            evaluate((*population)[i]);
+        }
+    }
+
+    void evaluate(Organism<GenType> &organism)
+    {
+        if(prepare(organism)) fitnessFunction_(organism);
+    }
+
+    // Repairs the genes and sums the constraint violation. Infeasible
+    // organisms get a placeholder fitness and return false.
+    bool prepare(Organism<GenType> &organism)
+    {
+        if(!lowerBounds_.empty() || !upperBounds_.empty())
+        {
+            repair_->repair(organism.chromosome, lowerBounds_, upperBounds_);
+        }
+        organism.violation = 0;
+        for(const auto &constraint : constraints_)
+        {
+            organism.violation += std::max(constraint(organism.chromosome),
+                                           0.0);
+        }
+        if(organism.violation > 0)
+        {
+            // Final value is assigned by the constraint handling
+            organism.fitness = (minimize_) ?
+                        std::numeric_limits<double>::max() :
+                        std::numeric_limits<double>::lowest();
+            return false;
+        }
+        return true;
+    }
+};
+
+}
+
+#endif // EVOLUTIONARYALGORITHM_H
@@ -0,0 +1,194 @@
+#ifndef GENE_H
+#define GENE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <random>
+#include <type_traits>
+#include <vector>
+#include "organism.h"
+
+namespace ga
+{
+
+// Type in which operators compute new gene values: floating genes keep
+// their own precision, integer genes are computed in double
+template<typename GenType>
+using GeneReal = typename std::conditional<
+        std::is_floating_point<GenType>::value, GenType, double>::type;
+
+// Uniform distribution producing values of a gene type
+template<typename GenType>
+using GeneUniformDistribution = typename std::conditional<
+        std::is_integral<GenType>::value,
+        std::uniform_int_distribution<long long>,
+        std::uniform_real_distribution<GenType> >::type;
+
+namespace detail
+{
+
+template<typename GenType, typename Real>
+GenType toGene(Real value, std::false_type)
+{
+    return static_cast<GenType>(value);
+}
+
+template<typename GenType, typename Real>
+GenType toGene(Real value, std::true_type)
+{
+    const double low = std::numeric_limits<GenType>::min();
+    const double high = std::numeric_limits<GenType>::max();
+    const double rounded = std::floor(static_cast<double>(value) + 0.5);
+    if(!(rounded > low)) return std::numeric_limits<GenType>::min();
+    if(rounded >= high) return std::numeric_limits<GenType>::max();
+    return static_cast<GenType>(rounded);
+}
+
+}
+
+// Converts a computed value into a gene, integer genes are rounded and
+// saturated instead of overflowing
+template<typename GenType, typename Real>
+GenType toGene(Real value)
+{
+    return detail::toGene<GenType>(value, std::is_integral<GenType>());
+}
+
+// Wraps a fitness function written for double genes into one for encoded
+// genes: decode(chromosome, values) fills the real parameters handed to
+// function, whose fitness and objectives are copied back
+template<typename GenType, typename Decode>
+std::function<void(Organism<GenType> &)>
+decodedFitness(Decode decode, std::function<void(Organism<double> &)> function)
+{
+    return [decode, function](Organism<GenType> &org) {
+        // Per thread and reused, as evaluations run in parallel
+        thread_local Organism<double> decoded;
+        decode(org.chromosome, decoded.chromosome);
+        decoded.objectives.clear();
+        function(decoded);
+        org.fitness = decoded.fitness;
+        org.objectives.swap(decoded.objectives);
+    };
+}
+
+// Fixed-point encoding of real variables: every integer gene is mapped
+// linearly onto [lower, upper] of its dimension, using the whole range of
+// the integer type (int16_t resolves 1 / 65535 of the interval). The
+// engine runs on the integer genes, bounded by lowerBounds() and
+// upperBounds(), while fitness() lets the fitness function see the
+// decoded real values.
+template<typename GenType = int16_t>
+class Quantizer
+{
+public:
+    Quantizer(const std::vector<double> &lower,
+              const std::vector<double> &upper) :
+        lower_(lower), step_(std::min(lower.size(), upper.size()))
+    {
+        static_assert(std::is_integral<GenType>::value &&
+                      !std::is_same<GenType, bool>::value,
+                      "Quantizer needs integer genes!");
+        const double levels = static_cast<double>(max()) - min();
+        for(size_t i = 0; i < step_.size(); ++i)
+        {
+            step_[i] = (upper[i] - lower[i]) / levels;
+        }
+        lower_.resize(step_.size());
+    }
+
+    size_t size() const
+    {
+        return step_.size();
+    }
+
+    // Real distance between neighboring gene values, e.g. to express
+    // mutation deviations in gene units
+    double step(size_t i) const
+    {
+        return step_[i];
+    }
+
+    double decode(GenType gene, size_t i) const
+    {
+        return lower_[i] + step_[i] * (static_cast<double>(gene) - min());
+    }
+
+    GenType encode(double value, size_t i) const
+    {
+        const double offset = (step_[i] > 0) ?
+                    (value - lower_[i]) / step_[i] : 0;
+        return toGene<GenType>(offset + min());
+    }
+
+    void decode(const std::vector<GenType> &chromosome,
+                std::vector<double> &values) const
+    {
+        values.resize(chromosome.size());
+        for(size_t i = 0; i < chromosome.size(); ++i)
+        {
+            values[i] = decode(chromosome[i], i);
+        }
+    }
+
+    std::vector<double> decode(const std::vector<GenType> &chromosome) const
+    {
+        std::vector<double> values;
+        decode(chromosome, values);
+        return values;
+    }
+
+    std::vector<GenType> encode(const std::vector<double> &values) const
+    {
+        std::vector<GenType> chromosome(values.size());
+        for(size_t i = 0; i < values.size(); ++i)
+        {
+            chromosome[i] = encode(values[i], i);
+        }
+        return chromosome;
+    }
+
+    std::vector<GenType> lowerBounds() const
+    {
+        return std::vector<GenType>(size(), min());
+    }
+
+    std::vector<GenType> upperBounds() const
+    {
+        return std::vector<GenType>(size(), max());
+    }
+
+    // Fitness function of the integer genes, which sees the decoded
+    // chromosome
+    std::function<void(Organism<GenType> &)>
+    fitness(std::function<void(Organism<double> &)> function) const
+    {
+        const Quantizer quantizer = *this;
+        return decodedFitness<GenType>(
+                    [quantizer](const std::vector<GenType> &chromosome,
+                                std::vector<double> &values) {
+            quantizer.decode(chromosome, values);
+        }, std::move(function));
+    }
+
+private:
+    std::vector<double> lower_;
+    std::vector<double> step_;
+
+    static constexpr GenType min()
+    {
+        return std::numeric_limits<GenType>::min();
+    }
+
+    static constexpr GenType max()
+    {
+        return std::numeric_limits<GenType>::max();
+    }
+};
+
+}
+
+#endif // GENE_H
@@ -4,25 +4,35 @@
 #include <algorithm>
 #include <functional>
 #include <memory>
+#include <numeric>
+#include <cmath>
 #include <ctime>
-#include <thread>
 
+#include "evolutionaryalgorithm.h"
 #include "organism.h"
-#include "initialization.h"
+#include "gene.h"
+#include "decoding.h"
 #include "fitnesscaling.h"
 #include "prepopulation.h"
 #include "selection.h"
 #include "crossover.h"
 #include "mutation.h"
 #include "stoppingcriteria.h"
-#include "display.h"
+#include "adaptation.h"
+#include "replacement.h"
+#include "niching.h"
+#include "multiobjective.h"
+#include "memetic.h"
+#include "surrogate.h"
+#include "snapshot.h"
+#include "scheduler.h"
+#include "numa.h"
+#include "differentialevolution.h"
+#include "cmaes.h"
 
 namespace ga
 {
 
-template<typename T>
-using InitializationPtr = std::unique_ptr<Initialization<T>>;
-
 template<typename T>
 using FitnessScalingPtr = std::unique_ptr<FitnessScaling<T>>;
 
@@ -39,37 +49,45 @@ template<typename T>
 using MutationPtr = std::unique_ptr<Mutation<T>>;
 
 template<typename T>
-using StoppingPtr = std::unique_ptr<StoppingCriteria<T>>;
+using AdaptationPtr = std::unique_ptr<Adaptation<T>>;
+
+template<typename T>
+using ReplacementPtr = std::unique_ptr<Replacement<T>>;
+
+template<typename T>
+using MemeticPtr = std::unique_ptr<Memetic<T>>;
 
 template<typename T>
-using DisplayPtr = std::unique_ptr<Display<T>>;
+using SurrogatePtr = std::unique_ptr<Surrogate<T>>;
 
 template<typename GenType>
-class GeneticAlgorithm
+class GeneticAlgorithm : public EvolutionaryAlgorithm<GenType>
 {
+    using Base = EvolutionaryAlgorithm<GenType>;
+    using Base::population_;
+    using Base::initialization_;
+    using Base::stopping_;
+    using Base::numberOfThreads_;
+    using Base::statistics_;
+    using Base::evaluations_;
+    using Base::minimize_;
+
 public:
     GeneticAlgorithm(size_t chromosomeSize, size_t populationSize = 50) :
-        initialization_(nullptr),
+        Base(chromosomeSize, populationSize),
         scale_(nullptr),
         prepopulation_(nullptr),
         selection_(nullptr),
-        crossover_(nullptr),
         mutation_(nullptr),
-        stopping_(nullptr),
-        display_(nullptr),
+        adaptation_(nullptr),
+        replacement_(nullptr),
+        memetic_(nullptr),
+        surrogate_(nullptr),
+        evaluatedFraction_(1),
         gen_(std::random_device()()),
-        distribution_(0, 100),
-        numberOfThreads_(1)
+        distribution_(0, 100)
     {
         srand(time(nullptr));
-        for(size_t i = 0; i < populationSize; ++i)
-        {
-            population_.emplace_back(chromosomeSize);
-        }
-    }
-    void setInitializationAlgorithm(InitializationPtr<GenType> initialization)
-    {
-        initialization_ = std::move(initialization);
     }
 
     void setFitnessScaleAlgorithm(FitnessScalingPtr<GenType> scale)
@@ -88,174 +106,571 @@ public:
     }
     void setCrossoverAlgorithm(CrossoverPtr<GenType> crossover)
     {
-        crossover_ = std::move(crossover);
+        crossovers_.clear();
+        crossovers_.push_back(std::move(crossover));
+    }
+    // Adds one more operator to the crossover mix
+    void addCrossoverAlgorithm(CrossoverPtr<GenType> crossover)
+    {
+        crossovers_.push_back(std::move(crossover));
     }
     void setMutationAlgorithm(MutationPtr<GenType> mutation)
     {
         mutation_ = std::move(mutation);
     }
-    void setStoppingCriteria(StoppingPtr<GenType> stopping)
+    void setAdaptationAlgorithm(AdaptationPtr<GenType> adaptation)
     {
-        stopping_ = std::move(stopping);
+        adaptation_ = std::move(adaptation);
     }
-    void setFitnessFunction(std::function<void(Organism<GenType> &)> fitness)
+    void setReplacementAlgorithm(ReplacementPtr<GenType> replacement)
     {
-        fitnessFunction_ = fitness;
+        replacement_ = std::move(replacement);
     }
-    void setDisplayFunction(DisplayPtr<GenType> display)
+    void setMemeticAlgorithm(MemeticPtr<GenType> memetic)
     {
-        display_ = std::move(display);
+        memetic_ = std::move(memetic);
     }
-
-    void setLinearBounds(std::vector<GenType> &&lower,
-                         std::vector<GenType> &&upper)
+    // Only the evaluatedFraction of the offspring which the surrogate
+    // predicts to be the best is sent to the fitness function, the other
+    // slots are taken by the best parents
+    void setSurrogateAlgorithm(SurrogatePtr<GenType> surrogate,
+                               double evaluatedFraction = 0.5)
     {
-        lowerBounds_ = lower;
-        upperBounds_ = upper;
+        surrogate_ = std::move(surrogate);
+        evaluatedFraction_ = evaluatedFraction;
+    }
+    // Keeps up to capacity non-dominated organisms seen during the run
+    void setParetoArchive(size_t capacity)
+    {
+        archive_ = ParetoArchive<GenType>(capacity);
     }
 
     Organism<GenType> optimize(double mutationProbability = 0.1,
                   bool minimize = true,
                   unsigned int numberOfThreads = 1)
     {
-        numberOfThreads_ = numberOfThreads;
+        begin(mutationProbability, minimize, numberOfThreads);
+        while(step()) {}
+
+        return population_.front();
+    }
+
+    // Starts a run which is driven by the caller: ask() hands out the
+    // organisms of the current generation which need a fitness, tell()
+    // takes their fitness back, possibly in many batches and in any order,
+    // and step() completes the generation and breeds the next one. The
+    // first generation is the initial population.
+    void begin(double mutationProbability = 0.1, bool minimize = true,
+               unsigned int numberOfThreads = 1)
+    {
+        restoreBatch();
+        this->start(minimize, numberOfThreads);
+        rates_.mutationProbability = mutationProbability;
+        rates_.mutationStep = 1;
+        rates_.crossoverWeights.assign(crossovers_.size(), 1);
+        if(mutation_) mutation_->setStepScale(rates_.mutationStep);
+        if(adaptation_) adaptation_->reset();
+        archive_.clear();
+        surrogateStatistics_ = SurrogateStatistics();
+        if(surrogate_) surrogate_->reset();
         initialization_->initialize(population_);
-        calcFitnessForPopulation();
-        for(unsigned long i = 0; !stopping_->stop(i, population_); ++i)
+        generation_ = 0;
+        refined_ = false;
+        initial_ = true;
+        running_ = true;
+        std::vector<size_t> slots(population_.size());
+        std::iota(slots.begin(), slots.end(), 0);
+        setBatch(population_, std::move(slots));
+    }
+
+    // Up to count (all if 0) organisms of the current generation which
+    // were not handed out yet. Their genes are already repaired, organisms
+    // violating constraints are never handed out.
+    std::vector< Candidate<GenType> > ask(size_t count = 0)
+    {
+        std::vector< Candidate<GenType> > candidates;
+        while(asked_ < batch_.size() && (!count || candidates.size() < count))
         {
-            calcFitnessForPopulation();
-            if(minimize)
-            {
-                std::sort(population_.begin(), population_.end());
-            }
-            else
-            {
-                std::sort(population_.begin(), population_.end(),
-                          std::greater<Organism <GenType> >());
-            }
-            if(scale_) scale_->scale(population_, minimize);
-            std::vector< Organism<GenType> > nextPopulation;
-            if(prepopulation_)
+            const size_t k = asked_++;
+            if(!this->prepare(batch_[k]))
             {
-                prepopulation_->prepopulate(population_, nextPopulation);
+                done_[k] = true;
+                continue;
             }
-            const auto parentPool = selection_->selection(population_);
-            while(nextPopulation.size() < population_.size())
-            {
-                size_t first = rand() % parentPool.size();
-                size_t second = rand() % parentPool.size();
-                const auto offspring =
-                        crossover_->crossover(parentPool[first],
-                                              parentPool[second]);
-                nextPopulation.insert(nextPopulation.end(),
-                                      offspring.begin(),
-                                      offspring.end());
-            }
-            while(nextPopulation.size() > population_.size())
+            candidates.push_back({batchBase_ + k, batch_[k]});
+        }
+        return candidates;
+    }
+
+    // Results of earlier generations and repeated results are ignored
+    void tell(const std::vector< Candidate<GenType> > &results)
+    {
+        for(const auto &result : results)
+        {
+            if(result.id < batchBase_ || result.id - batchBase_ >= asked_)
             {
-                nextPopulation.pop_back();
+                continue;
             }
-            if(mutation_)
-            {
-                for(auto &organism : nextPopulation)
-                {
-                    if(distribution_(gen_) <= mutationProbability)
-                    {
-                        mutation_->mutation(organism.chromosome);
-                    }
-                }
-            }
-
-            if(display_) display_->display(population_, i);
-
-            population_ = std::move(nextPopulation);
+            const size_t k = result.id - batchBase_;
+            if(done_[k]) continue;
+            batch_[k].fitness = result.organism.fitness;
+            batch_[k].objectives = result.organism.objectives;
+            done_[k] = true;
+            ++evaluations_;
         }
+    }
 
-        calcFitnessForPopulation();
-        if(minimize)
+    // Completes the current generation, evaluating the organisms which
+    // weren't told with the fitness function, and breeds the next one.
+    // Returns false once the stopping criteria are met, the population is
+    // then sorted.
+    bool step()
+    {
+        if(!running_) return false;
+        this->evaluatePopulation(batch_, &done_);
+        this->handleConstraints(batch_);
+        learn(batch_);
+        restoreBatch();
+        if(initial_)
         {
-            std::sort(population_.begin(), population_.end());
+            initial_ = false;
+            archive_.insert(population_, minimize_);
+            if(replacement_)
+            {
+                replacement_->setNumberOfThreads(numberOfThreads_);
+                replacement_->setExecutor(this->executor_);
+                replacement_->initialize(population_, minimize_);
+            }
+            this->updateStatistics(0, minimize_);
         }
         else
         {
-            std::sort(population_.begin(), population_.end(),
-                      std::greater<Organism <GenType> >());
+            completeGeneration();
+        }
+        if(this->shouldStop(generation_))
+        {
+            this->sortPopulation(minimize_);
+            running_ = false;
+            return false;
         }
+        breed();
+        return true;
+    }
 
-        return population_.front();
+    // Best organism of the last completed generation
+    const Organism<GenType> &best() const
+    {
+        return *std::min_element(population_.begin(), population_.end(),
+                                 [this](const Organism<GenType> &lhs,
+                                        const Organism<GenType> &rhs) {
+            return this->better(lhs, rhs);
+        });
+    }
+
+    // Best organisms of distinct niches of the final population
+    Population<GenType> optima(double radius, size_t maxCount = 0) const
+    {
+        return distinctOptima(population_, radius, maxCount);
+    }
+
+    // Non-dominated organisms: the archive if enabled, otherwise the first
+    // front of the final population
+    Population<GenType> paretoFront(bool minimize = true) const
+    {
+        if(!archive_.members().empty()) return archive_.members();
+        ObjectiveMatrix objectives;
+        objectives.assign(population_, minimize);
+        Population<GenType> front;
+        if(!objectives.rows()) return front;
+        for(size_t i : nonDominatedSort(objectives).front())
+        {
+            front.push_back(population_[objectives.index(i)]);
+        }
+        return front;
+    }
+
+    const OperatorRates &rates() const
+    {
+        return rates_;
+    }
+
+    const SurrogateStatistics &surrogateStatistics() const
+    {
+        return surrogateStatistics_;
     }
 
 private:
-    Population<GenType> population_;
-    InitializationPtr<GenType> initialization_;
     FitnessScalingPtr<GenType> scale_;
     PrepopulationPtr<GenType>  prepopulation_;
     SelectionPtr<GenType> selection_;
-    CrossoverPtr<GenType> crossover_;
+    std::vector< CrossoverPtr<GenType> > crossovers_;
     MutationPtr<GenType> mutation_;
-    StoppingPtr<GenType> stopping_;
-    DisplayPtr<GenType> display_;
-
-    std::vector<GenType> lowerBounds_;
-    std::vector<GenType> upperBounds_;
-
-    std::function<void(Organism<GenType> &)> fitnessFunction_;
+    AdaptationPtr<GenType> adaptation_;
+    ReplacementPtr<GenType> replacement_;
+    MemeticPtr<GenType> memetic_;
+    SurrogatePtr<GenType> surrogate_;
+    double evaluatedFraction_;
+    SurrogateStatistics surrogateStatistics_;
+    unsigned long checkedPredictions_ = 0;
+    ParetoArchive<GenType> archive_{0};
 
     std::mt19937_64 gen_;
     std::uniform_real_distribution<> distribution_;
 
-    unsigned int numberOfThreads_;
+    OperatorRates rates_;
+    std::vector<OffspringRecord> records_;
+    std::vector<ReplacementSwap> swaps_;
+    std::vector<double> parentFitness_;
+    // Local search changed genes of the population this generation
+    bool refined_ = false;
+
+    bool running_ = false;
+    bool initial_ = false;
+    unsigned long generation_ = 0;
+    Population<GenType> offspring_;
+    // Organisms of the current generation waiting for their fitness, moved
+    // out of their slots in the population (initially) or the offspring
+    Population<GenType> batch_;
+    std::vector<size_t> slots_;
+    std::vector<char> done_;
+    size_t asked_ = 0;
+    // Candidate id of the first organism of the batch
+    size_t batchBase_ = 0;
+    // Pre-screening of the current offspring
+    bool screened_ = false;
+    std::vector<double> predicted_;
+    std::vector<size_t> candidates_;
+    size_t keep_ = 0;
+    size_t prepopulated_ = 0;
 
-    void calcFitnessForPopulation()
+    size_t chooseCrossover()
     {
-        if(numberOfThreads_ <= 1)
+        if(crossovers_.size() == 1) return 0;
+        const auto &weights = rates_.crossoverWeights;
+        double value = std::uniform_real_distribution<>(
+                    0, std::accumulate(weights.begin(), weights.end(), 0.0))(
+                    gen_);
+        for(size_t i = 0; i < weights.size() - 1; ++i)
         {
-            calcFitnessForPopulationPart(0, population_.size());
+            if(value < weights[i]) return i;
+            value -= weights[i];
         }
-        else
+        return weights.size() - 1;
+    }
+
+    // Sorts by scaled fitness keeping the raw fitness values aligned
+    void sortScaledPopulation(bool minimize)
+    {
+        std::vector<size_t> order(population_.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(),
+                         [&](size_t lhs, size_t rhs) {
+            return (minimize) ?
+                        population_[lhs].fitness < population_[rhs].fitness :
+                        population_[lhs].fitness > population_[rhs].fitness;
+        });
+        Population<GenType> sorted;
+        sorted.reserve(population_.size());
+        std::vector<double> fitness(population_.size());
+        for(size_t j = 0; j < order.size(); ++j)
+        {
+            sorted.push_back(std::move(population_[order[j]]));
+            fitness[j] = parentFitness_[order[j]];
+        }
+        population_ = std::move(sorted);
+        parentFitness_ = std::move(fitness);
+    }
+
+    void learn(const Population<GenType> &population)
+    {
+        if(!surrogate_) return;
+        for(const auto &org : population) surrogate_->add(org);
+    }
+
+    void breed()
+    {
+        this->sortPopulation(minimize_);
+        if(memetic_)
         {
-            size_t step = population_.size() / numberOfThreads_;
-            size_t currentPosition = 0;
-            std::thread threads[numberOfThreads_];
-            for(unsigned int i = 0; i < (numberOfThreads_ - 1); ++i)
+            const size_t used = memetic_->refine(
+                        population_, generation_,
+                        [this](Organism<GenType> &org) {
+                            this->evaluate(org);
+                        },
+                        minimize_, numberOfThreads_, this->executor_.get());
+            if(used)
             {
-                threads[i] = std::thread(&GeneticAlgorithm<GenType>::
-                                         calcFitnessForPopulationPart,
-                              this, currentPosition, currentPosition + step);
-                currentPosition += step;
+                evaluations_ += used;
+                this->sortPopulation(minimize_);
+                refined_ = memetic_->lamarckian();
             }
-            threads[numberOfThreads_ - 1] =
-                    std::thread(&GeneticAlgorithm<GenType>::
-                                calcFitnessForPopulationPart,
-                          this, currentPosition, population_.size());
-            for(size_t i = 0; i < numberOfThreads_; ++i)
+        }
+        parentFitness_.resize(population_.size());
+        for(size_t j = 0; j < population_.size(); ++j)
+        {
+            parentFitness_[j] = population_[j].fitness;
+        }
+        if(scale_)
+        {
+            scale_->scale(population_, minimize_);
+            sortScaledPopulation(minimize_);
+        }
+        offspring_.clear();
+        if(prepopulation_ &&
+           (!replacement_ || replacement_->usesPrepopulation()))
+        {
+            prepopulation_->prepopulate(population_, offspring_);
+        }
+        // Only the offspring the replacement strategy takes are bred
+        const size_t count = std::max<size_t>(
+                    (replacement_) ?
+                        replacement_->offspringCount(population_.size()) :
+                        population_.size(), 1);
+        // Every generation breeds at least one new child
+        if(offspring_.size() >= count) offspring_.resize(count - 1);
+        records_.assign(offspring_.size(), OffspringRecord());
+        offspring_.reserve(count + 1);
+        const auto parentPool = selection_->selection(population_);
+        while(offspring_.size() < count)
+        {
+            OffspringRecord record;
+            record.first = parentPool[rand() % parentPool.size()];
+            record.second = parentPool[rand() % parentPool.size()];
+            record.crossover = chooseCrossover();
+            const auto offspring =
+                    crossovers_[record.crossover]->crossover(
+                        population_[record.first],
+                        population_[record.second]);
+            offspring_.insert(offspring_.end(), offspring.begin(),
+                              offspring.end());
+            records_.insert(records_.end(), offspring.size(), record);
+        }
+        while(offspring_.size() > count)
+        {
+            offspring_.pop_back();
+            records_.pop_back();
+        }
+        if(scale_)
+        {
+            // Selection is done, the parents keep their raw fitness
+            for(size_t j = 0; j < population_.size(); ++j)
             {
-                threads[i].join();
+                population_[j].fitness = parentFitness_[j];
             }
         }
+        if(mutation_)
+        {
+            for(size_t j = 0; j < offspring_.size(); ++j)
+            {
+                if(distribution_(gen_) <= rates_.mutationProbability)
+                {
+                    mutation_->mutation(offspring_[j].chromosome);
+                    records_[j].mutated = true;
+                }
+            }
+        }
+
+        this->display(generation_);
+
+        screenOffspring();
     }
 
-    void calcFitnessForPopulationPart(size_t start, size_t end)
+    void completeGeneration()
     {
-        for(size_t i = start; i < end; ++i)
+        if(screened_)
         {
-            auto &organism = population_[i];
-            for(size_t i = 0; i < lowerBounds_.size(); ++i)
+            checkPredictions(offspring_, predicted_, candidates_, keep_);
+            // Rejected slots go to the best parents which weren't
+            // prepopulated
+            for(size_t k = keep_; k < candidates_.size(); ++k)
             {
-                if(organism.chromosome[i] < lowerBounds_[i])
-                {
-                    organism.chromosome[i] = lowerBounds_[i];
-                }
+                const size_t parent = (prepopulated_ + k - keep_) %
+                        population_.size();
+                offspring_[candidates_[k]] = population_[parent];
+                records_[candidates_[k]] = OffspringRecord();
             }
-            for(size_t i = 0; i < upperBounds_.size(); ++i)
+            surrogateStatistics_.screened += candidates_.size();
+            surrogateStatistics_.evaluated += keep_;
+            surrogateStatistics_.saved += candidates_.size() - keep_;
+        }
+        archive_.insert(offspring_, minimize_);
+        // Collected before the replacement takes the offspring
+        AdaptationFeedback feedback;
+        if(adaptation_) feedback = adaptationFeedback(offspring_, minimize_);
+        swaps_.clear();
+        const bool swapped = replacement_ &&
+                replacement_->replace(population_, offspring_, records_,
+                                      minimize_, swaps_);
+        if(!replacement_) population_ = std::move(offspring_);
+        // Swaps update the diversity tracker in place, unless local search
+        // changed genes which it doesn't know about
+        if(swapped && !refined_)
+        {
+            for(const ReplacementSwap &swap : swaps_)
             {
-                if(organism.chromosome[i] > upperBounds_[i])
-                {
-                    organism.chromosome[i] = upperBounds_[i];
-                }
+                this->trackReplacement(offspring_[swap.child].chromosome,
+                                       population_[swap.slot].chromosome);
+            }
+            this->diversityTracked_ = true;
+        }
+        refined_ = false;
+        ++generation_;
+        this->updateStatistics(generation_, minimize_);
+        // Reacts to the statistics of the generation just completed
+        if(adaptation_)
+        {
+            adaptation_->adapt(statistics_, feedback, rates_);
+            if(mutation_) mutation_->setStepScale(rates_.mutationStep);
+        }
+    }
+
+    // Chooses the offspring which go to the fitness function: all of them,
+    // or with a ready surrogate the prepopulated ones and the share of the
+    // others which it predicts to be the best. Already evaluated
+    // chromosomes take the archived fitness.
+    void screenOffspring()
+    {
+        std::vector<size_t> selected;
+        screened_ = surrogate_ && surrogate_->ready();
+        if(!screened_)
+        {
+            selected.resize(offspring_.size());
+            std::iota(selected.begin(), selected.end(), 0);
+            setBatch(offspring_, std::move(selected));
+            return;
+        }
+        candidates_.clear();
+        predicted_.assign(offspring_.size(), 0);
+        for(size_t i = 0; i < offspring_.size(); ++i)
+        {
+            if(records_[i].crossover == OffspringRecord::none)
+            {
+                selected.push_back(i);
+                continue;
+            }
+            if(surrogate_->lookup(offspring_[i].chromosome,
+                                  offspring_[i].fitness))
+            {
+                offspring_[i].violation = 0;
+                ++surrogateStatistics_.cached;
+                ++surrogateStatistics_.saved;
+                continue;
+            }
+            candidates_.push_back(i);
+            predicted_[i] = surrogate_->predict(offspring_[i].chromosome);
+        }
+        prepopulated_ = selected.size();
+        keep_ = std::min(candidates_.size(), std::max<size_t>(
+                    1, std::ceil(evaluatedFraction_ * candidates_.size())));
+        std::stable_sort(candidates_.begin(), candidates_.end(),
+                         [&](size_t lhs, size_t rhs) {
+            return (minimize_) ? predicted_[lhs] < predicted_[rhs] :
+                                 predicted_[lhs] > predicted_[rhs];
+        });
+        selected.insert(selected.end(), candidates_.begin(),
+                        candidates_.begin() + keep_);
+        setBatch(offspring_, std::move(selected));
+    }
+
+    // Moves the organisms at slots of population into the batch
+    void setBatch(Population<GenType> &population, std::vector<size_t> slots)
+    {
+        batchBase_ += slots_.size();
+        slots_ = std::move(slots);
+        batch_.clear();
+        batch_.reserve(slots_.size());
+        for(size_t slot : slots_) batch_.push_back(std::move(population[slot]));
+        done_.assign(batch_.size(), false);
+        asked_ = 0;
+    }
+
+    // Moves the batch back into the population it was taken from
+    void restoreBatch()
+    {
+        Population<GenType> &population = (initial_) ? population_ :
+                                                       offspring_;
+        for(size_t k = 0; k < batch_.size(); ++k)
+        {
+            population[slots_[k]] = std::move(batch_[k]);
+        }
+        batch_.clear();
+    }
+
+    void checkPredictions(const Population<GenType> &offspring,
+                          const std::vector<double> &predicted,
+                          const std::vector<size_t> &candidates, size_t keep)
+    {
+        std::vector<size_t> checked;
+        for(size_t k = 0; k < keep; ++k)
+        {
+            if(offspring[candidates[k]].violation <= 0)
+            {
+                checked.push_back(candidates[k]);
+            }
+        }
+        double &error = surrogateStatistics_.meanAbsoluteError;
+        for(size_t i : checked)
+        {
+            ++checkedPredictions_;
+            error += (std::abs(predicted[i] - offspring[i].fitness) - error) /
+                    checkedPredictions_;
+        }
+        const size_t size = checked.size();
+        if(size < 3) return;
+        auto ranks = [&](std::function<double(size_t)> value) {
+            std::vector<size_t> order(size);
+            std::iota(order.begin(), order.end(), 0);
+            std::sort(order.begin(), order.end(), [&](size_t l, size_t r) {
+                return value(checked[l]) < value(checked[r]);
+            });
+            std::vector<double> rank(size);
+            for(size_t k = 0; k < size; ++k) rank[order[k]] = k;
+            return rank;
+        };
+        const auto predictedRank = ranks([&](size_t i) {
+            return predicted[i];
+        });
+        const auto trueRank = ranks([&](size_t i) {
+            return offspring[i].fitness;
+        });
+        double squares = 0;
+        for(size_t k = 0; k < size; ++k)
+        {
+            const double delta = predictedRank[k] - trueRank[k];
+            squares += delta * delta;
+        }
+        surrogateStatistics_.rankCorrelation =
+                1 - 6 * squares / (size * (size * size - 1.0));
+    }
+
+    AdaptationFeedback adaptationFeedback(
+            const Population<GenType> &offspring, bool minimize) const
+    {
+        AdaptationFeedback feedback;
+        feedback.crossoverUses.assign(crossovers_.size(), 0);
+        feedback.crossoverCredit.assign(crossovers_.size(), 0);
+        for(size_t i = 0; i < records_.size(); ++i)
+        {
+            const OffspringRecord &record = records_[i];
+            if(record.crossover == OffspringRecord::none) continue;
+            const double first = parentFitness_[record.first];
+            const double second = parentFitness_[record.second];
+            const double fitness = offspring[i].fitness;
+            const double improvement = (minimize) ?
+                        std::min(first, second) - fitness :
+                        fitness - std::max(first, second);
+            ++feedback.crossoverUses[record.crossover];
+            if(improvement > 0)
+            {
+                feedback.crossoverCredit[record.crossover] += improvement;
+            }
+            if(record.mutated)
+            {
+                ++feedback.mutations;
+                if(improvement > 0) ++feedback.mutationSuccesses;
             }
-            fitnessFunction_(organism);
         }
+        return feedback;
     }
 };
 
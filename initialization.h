@@ -2,6 +2,7 @@
 #define INITIALIZATION_H
 
 #include "organism.h"
+#include "gene.h"
 #include "geneticalgorithm.h"
 #include <random>
 
@@ -20,27 +21,32 @@ template<typename GenType>
 class UniformInitialization : public Initialization<GenType>
 {
 public:
-    UniformInitialization(std::vector<double> &&mins,
-                          std::vector<double> &&maxs) :
-        mins_(mins), maxs_(maxs), gen_(std::random_device()()) {}
+    UniformInitialization(std::vector<GenType> &&mins,
+                          std::vector<GenType> &&maxs) :
+        mins_(mins), maxs_(maxs), gen_(std::random_device()())
+    {
+        static_assert(!std::is_same<GenType, bool>::value,
+                 "UniformInitialization doesn't work with binary encoding!");
+    }
     void initialize(Population<GenType> &population) override
     {
+        using Range = typename GeneUniformDistribution<GenType>::param_type;
         for(auto &org : population)
         {
             for(size_t i = 0; i < org.chromosome.size(); ++i)
             {
-                distribution_ =
-                        std::uniform_real_distribution<>(mins_[i], maxs_[i]);
-                org.chromosome[i] = distribution_(gen_);
+                distribution_.param(Range(mins_[i], maxs_[i]));
+                org.chromosome[i] =
+                        static_cast<GenType>(distribution_(gen_));
             }
         }
     }
 
 private:
-    std::vector<double> mins_;
-    std::vector<double> maxs_;
+    std::vector<GenType> mins_;
+    std::vector<GenType> maxs_;
     std::mt19937_64 gen_;
-    std::uniform_real_distribution<> distribution_;
+    GeneUniformDistribution<GenType> distribution_;
 };
 
 class BinaryInitialization : public Initialization<bool>
@@ -74,14 +80,15 @@ public:
         {
             for(size_t i = 0; i < org.chromosome.size(); ++i)
             {
-                org.chromosome[i] = distribution_(generator_);
+                org.chromosome[i] =
+                        toGene<GenType>(distribution_(generator_));
             }
         }
     }
 
 private:
     std::default_random_engine generator_;
-    std::normal_distribution<GenType> distribution_;
+    std::normal_distribution< GeneReal<GenType> > distribution_;
 };
 
 }
@@ -9,24 +9,19 @@ using namespace ga;
 int main()
 {
     auto t1 = chrono::high_resolution_clock::now();
-    GeneticAlgorithm<bool> ga(10, 30);
+    BinaryDecoder decoder;
+    decoder.addInteger(10);
+    GeneticAlgorithm<bool> ga(decoder.length(), 30);
     ga.setInitializationAlgorithm(make_unique<BinaryInitialization>());
     ga.setPrepopulationAlgorithm(make_unique< EliteStrategy<bool> >(2));
     ga.setSelectionAlgorithm(make_unique< TournamentSelection<bool> >(4));
     ga.setCrossoverAlgorithm(make_unique< MultiPointCrossover<bool> >(2));
     ga.setMutationAlgorithm(make_unique<BinaryMutation>());
     ga.setStoppingCriteria(make_unique< FitnessCriteria<bool> >(1));
-    ga.setFitnessFunction([](Organism<bool> &org) {
-        int number = 0;
-        for(size_t i = 0; i < org.chromosome.size(); ++i)
-        {
-            if(org.chromosome[i])
-            {
-                number |= (1 << (org.chromosome.size() - i - 1));
-            }
-        }
+    ga.setFitnessFunction(decoder.fitness([](Organism<double> &org) {
+        const double number = org.chromosome[0];
         org.fitness = number * number + 1;
-    });
+    }));
 
     ga.setDisplayFunction(make_unique< SimpleDisplay<bool> >());
 
@@ -0,0 +1,301 @@
+#ifndef MEMETIC_H
+#define MEMETIC_H
+
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "organism.h"
+#include "gene.h"
+#include "parallel.h"
+#include "geneticalgorithm.h"
+
+namespace ga
+{
+
+template<typename GenType>
+using FitnessFunction = std::function<void(Organism<GenType> &)>;
+
+// Improves an evaluated organism in place using at most budget fitness
+// evaluations. Returns the number of evaluations spent. Implementations
+// must be safe to call from several threads at once.
+template<typename GenType>
+class LocalSearch
+{
+public:
+    virtual size_t search(Organism<GenType> &, const FitnessFunction<GenType> &,
+                          size_t budget, bool minimize) = 0;
+    virtual ~LocalSearch() = default;
+};
+
+template<typename GenType>
+class NelderMead : public LocalSearch<GenType>
+{
+public:
+    NelderMead(double step = 1, double tolerance = 1e-10) :
+        step_(step), tolerance_(tolerance)
+    {
+        static_assert(!std::is_same<GenType, bool>::value,
+                      "NelderMead doesn't work with binary encoding!");
+    }
+    size_t search(Organism<GenType> &org,
+                  const FitnessFunction<GenType> &fitness,
+                  size_t budget, bool minimize) override
+    {
+        const size_t size = org.chromosome.size();
+        if(!size || budget < size + 1) return 0;
+        const double sign = (minimize) ? 1 : -1;
+        size_t used = 0;
+        Organism<GenType> probe = org;
+        auto cost = [&](Organism<GenType> &candidate) {
+            fitness(candidate);
+            ++used;
+            return sign * candidate.fitness;
+        };
+
+        std::vector<Organism<GenType> > simplex(size + 1, org);
+        std::vector<double> costs(size + 1, sign * org.fitness);
+        for(size_t i = 0; i < size; ++i)
+        {
+            auto &gene = simplex[i + 1].chromosome[i];
+            gene = toGene<GenType>(gene + step_);
+            costs[i + 1] = cost(simplex[i + 1]);
+        }
+        std::vector<size_t> order(size + 1);
+        std::vector<double> centroid(size);
+        while(used < budget)
+        {
+            std::iota(order.begin(), order.end(), 0);
+            std::sort(order.begin(), order.end(), [&](size_t l, size_t r) {
+                return costs[l] < costs[r];
+            });
+            const size_t best = order.front();
+            const size_t worst = order.back();
+            const size_t second = order[size - 1];
+            if(costs[worst] - costs[best] <= tolerance_) break;
+
+            std::fill(centroid.begin(), centroid.end(), 0);
+            for(size_t k = 0; k < size; ++k)
+            {
+                const auto &vertex = simplex[order[k]].chromosome;
+                for(size_t i = 0; i < size; ++i) centroid[i] += vertex[i];
+            }
+            for(auto &value : centroid) value /= size;
+
+            auto point = [&](double coefficient) {
+                const auto &vertex = simplex[worst].chromosome;
+                for(size_t i = 0; i < size; ++i)
+                {
+                    probe.chromosome[i] = toGene<GenType>(centroid[i] +
+                            coefficient * (vertex[i] - centroid[i]));
+                }
+                return cost(probe);
+            };
+
+            const double reflected = point(-1);
+            if(reflected < costs[best])
+            {
+                Organism<GenType> reflection = probe;
+                const double expanded = (used < budget) ? point(-2) :
+                                                          reflected;
+                if(expanded < reflected)
+                {
+                    simplex[worst] = probe;
+                    costs[worst] = expanded;
+                }
+                else
+                {
+                    simplex[worst] = std::move(reflection);
+                    costs[worst] = reflected;
+                }
+                continue;
+            }
+            if(reflected < costs[second])
+            {
+                simplex[worst] = probe;
+                costs[worst] = reflected;
+                continue;
+            }
+            if(used >= budget) break;
+            const double contracted = (reflected < costs[worst]) ?
+                        point(-0.5) : point(0.5);
+            if(contracted < std::min(reflected, costs[worst]))
+            {
+                simplex[worst] = probe;
+                costs[worst] = contracted;
+                continue;
+            }
+            // Shrink towards the best vertex
+            for(size_t k = 1; k <= size && used < budget; ++k)
+            {
+                auto &vertex = simplex[order[k]];
+                for(size_t i = 0; i < size; ++i)
+                {
+                    vertex.chromosome[i] = toGene<GenType>(
+                                simplex[best].chromosome[i] + 0.5 *
+                                (vertex.chromosome[i] -
+                                 simplex[best].chromosome[i]));
+                }
+                costs[order[k]] = cost(vertex);
+            }
+        }
+        const size_t best = std::min_element(costs.begin(), costs.end()) -
+                costs.begin();
+        if(costs[best] < sign * org.fitness) org = simplex[best];
+        return used;
+    }
+
+private:
+    const double step_;
+    const double tolerance_;
+};
+
+// Compass search: tries +-step along every coordinate and halves the step
+// after a sweep without improvement
+template<typename GenType>
+class PatternSearch : public LocalSearch<GenType>
+{
+public:
+    PatternSearch(double step = 1, double minStep = 1e-8) :
+        step_(step), minStep_(minStep)
+    {
+        static_assert(!std::is_same<GenType, bool>::value,
+                      "PatternSearch doesn't work with binary encoding!");
+    }
+    size_t search(Organism<GenType> &org,
+                  const FitnessFunction<GenType> &fitness,
+                  size_t budget, bool minimize) override
+    {
+        const double sign = (minimize) ? 1 : -1;
+        size_t used = 0;
+        double step = step_;
+        Organism<GenType> probe = org;
+        while(used < budget && step >= minStep_)
+        {
+            bool improved = false;
+            for(size_t i = 0; i < org.chromosome.size() && used < budget; ++i)
+            {
+                for(double direction : {1.0, -1.0})
+                {
+                    if(used >= budget) break;
+                    probe.chromosome = org.chromosome;
+                    probe.chromosome[i] = toGene<GenType>(
+                                probe.chromosome[i] + direction * step);
+                    fitness(probe);
+                    ++used;
+                    if(sign * probe.fitness < sign * org.fitness)
+                    {
+                        org = probe;
+                        improved = true;
+                        break;
+                    }
+                }
+            }
+            if(!improved) step *= 0.5;
+        }
+        return used;
+    }
+
+private:
+    const double step_;
+    const double minStep_;
+};
+
+// First-improvement hill climbing over single bit flips in random order
+class BitFlipHillClimbing : public LocalSearch<bool>
+{
+public:
+    size_t search(Organism<bool> &org, const FitnessFunction<bool> &fitness,
+                  size_t budget, bool minimize) override
+    {
+        const double sign = (minimize) ? 1 : -1;
+        std::minstd_rand gen(std::random_device{}());
+        std::vector<size_t> order(org.chromosome.size());
+        std::iota(order.begin(), order.end(), 0);
+        size_t used = 0;
+        Organism<bool> probe = org;
+        bool improved = true;
+        while(improved && used < budget)
+        {
+            improved = false;
+            std::shuffle(order.begin(), order.end(), gen);
+            for(size_t bit : order)
+            {
+                if(used >= budget) break;
+                probe.chromosome[bit] = !probe.chromosome[bit];
+                fitness(probe);
+                ++used;
+                if(sign * probe.fitness < sign * org.fitness)
+                {
+                    org = probe;
+                    improved = true;
+                }
+                else
+                {
+                    probe.chromosome[bit] = !probe.chromosome[bit];
+                }
+            }
+        }
+        return used;
+    }
+};
+
+// Refines the best organisms of a sorted population every `period`
+// generations. Lamarckian refinement writes the improved genes back,
+// Baldwinian refinement keeps the genes and only takes the fitness.
+template<typename GenType>
+class Memetic
+{
+public:
+    Memetic(std::unique_ptr< LocalSearch<GenType> > search,
+            size_t elites = 2, unsigned long period = 10,
+            size_t budget = 100, bool lamarckian = true) :
+        search_(std::move(search)),
+        elites_(elites),
+        period_(period),
+        budget_(budget),
+        lamarckian_(lamarckian) {}
+
+    // Whether refinement changes genes
+    bool lamarckian() const
+    {
+        return lamarckian_;
+    }
+
+    // Returns the number of fitness evaluations spent
+    size_t refine(Population<GenType> &population, unsigned long generation,
+                  const FitnessFunction<GenType> &fitness, bool minimize,
+                  unsigned int numberOfThreads, Executor *executor = nullptr)
+    {
+        if(!period_ || generation % period_) return 0;
+        const size_t count = std::min(elites_, population.size());
+        if(!count) return 0;
+        const size_t budget = std::max<size_t>(budget_ / count, 1);
+        std::vector<size_t> used(count, 0);
+        parallelFor(count, numberOfThreads, executor,
+                    [&](size_t begin, size_t end) {
+            for(size_t i = begin; i < end; ++i)
+            {
+                Organism<GenType> candidate = population[i];
+                used[i] = search_->search(candidate, fitness, budget,
+                                          minimize);
+                if(lamarckian_) population[i] = std::move(candidate);
+                else population[i].fitness = candidate.fitness;
+            }
+        });
+        return std::accumulate(used.begin(), used.end(), size_t(0));
+    }
+
+private:
+    std::unique_ptr< LocalSearch<GenType> > search_;
+    const size_t elites_;
+    const unsigned long period_;
+    const size_t budget_;
+    const bool lamarckian_;
+};
+
+}
+
+#endif // MEMETIC_H
@@ -0,0 +1,431 @@
+#ifndef MULTIOBJECTIVE_H
+#define MULTIOBJECTIVE_H
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <vector>
+#include "organism.h"
+#include "parallel.h"
+#include "replacement.h"
+#include "geneticalgorithm.h"
+
+namespace ga
+{
+
+// Row-major matrix of objective values, one row per feasible organism.
+// Values are negated for maximization so that every objective is
+// minimized.
+class ObjectiveMatrix
+{
+public:
+    template<typename GenType>
+    void assign(const Population<GenType> &population, bool minimize)
+    {
+        // Infeasible organisms have no objectives
+        indices_.clear();
+        for(size_t i = 0; i < population.size(); ++i)
+        {
+            if(population[i].violation <= 0) indices_.push_back(i);
+        }
+        rows_ = indices_.size();
+        columns_ = (rows_) ? population[indices_.front()].objectives.size() :
+                             0;
+        data_.resize(rows_ * columns_);
+        const double sign = (minimize) ? 1 : -1;
+        for(size_t i = 0; i < rows_; ++i)
+        {
+            const auto &objectives = population[indices_[i]].objectives;
+            for(size_t j = 0; j < columns_; ++j)
+            {
+                data_[i * columns_ + j] = sign * objectives[j];
+            }
+        }
+    }
+
+    const double *row(size_t i) const { return &data_[i * columns_]; }
+    double at(size_t i, size_t j) const { return data_[i * columns_ + j]; }
+    size_t rows() const { return rows_; }
+    size_t columns() const { return columns_; }
+    // Population index of a row
+    size_t index(size_t i) const { return indices_[i]; }
+
+private:
+    std::vector<double> data_;
+    std::vector<size_t> indices_;
+    size_t rows_ = 0;
+    size_t columns_ = 0;
+};
+
+inline bool dominates(const double *lhs, const double *rhs, size_t size)
+{
+    bool better = false;
+    for(size_t i = 0; i < size; ++i)
+    {
+        if(lhs[i] > rhs[i]) return false;
+        if(lhs[i] < rhs[i]) better = true;
+    }
+    return better;
+}
+
+// Splits rows into non-dominated fronts. Uses Jensen's O(n log n) sweep
+// for two objectives and the efficient non-dominated sort with binary
+// search (ENS-BS) otherwise. Returns the fronts best first.
+inline std::vector< std::vector<size_t> >
+nonDominatedSort(const ObjectiveMatrix &objectives)
+{
+    const size_t size = objectives.rows();
+    const size_t columns = objectives.columns();
+    std::vector<size_t> order(size);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+        return std::lexicographical_compare(
+                    objectives.row(lhs), objectives.row(lhs) + columns,
+                    objectives.row(rhs), objectives.row(rhs) + columns);
+    });
+    std::vector< std::vector<size_t> > fronts;
+    if(columns == 2)
+    {
+        // Minimal second objective of every front, ascending
+        std::vector<double> minimums;
+        size_t front = 0;
+        for(size_t k = 0; k < size; ++k)
+        {
+            const size_t index = order[k];
+            const double *point = objectives.row(index);
+            if(k && std::equal(point, point + 2,
+                               objectives.row(order[k - 1])))
+            {
+                // Duplicates share the front of their twin
+                fronts[front].push_back(index);
+                continue;
+            }
+            front = std::upper_bound(
+                        minimums.begin(), minimums.end(), point[1],
+                        [](double value, double minimum) {
+                return value < minimum;
+            }) - minimums.begin();
+            if(front == fronts.size())
+            {
+                fronts.emplace_back();
+                minimums.push_back(point[1]);
+            }
+            fronts[front].push_back(index);
+            minimums[front] = point[1];
+        }
+        return fronts;
+    }
+    for(size_t index : order)
+    {
+        const double *point = objectives.row(index);
+        size_t low = 0;
+        size_t high = fronts.size();
+        while(low < high)
+        {
+            const size_t middle = (low + high) / 2;
+            const auto &front = fronts[middle];
+            bool dominated = false;
+            for(auto member = front.rbegin(); member != front.rend();
+                ++member)
+            {
+                if(dominates(objectives.row(*member), point, columns))
+                {
+                    dominated = true;
+                    break;
+                }
+            }
+            if(dominated) low = middle + 1;
+            else high = middle;
+        }
+        if(low == fronts.size()) fronts.emplace_back();
+        fronts[low].push_back(index);
+    }
+    return fronts;
+}
+
+namespace detail
+{
+
+// Adds the normalized neighbor distances along objective j to distances
+inline void addCrowding(const ObjectiveMatrix &objectives,
+                        const std::vector<size_t> &front, size_t j,
+                        std::vector<size_t> &order, double *distances)
+{
+    const size_t size = front.size();
+    const double infinity = std::numeric_limits<double>::infinity();
+    if(size <= 2)
+    {
+        std::fill(distances, distances + size, infinity);
+        return;
+    }
+    order.resize(size);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+        return objectives.at(front[lhs], j) < objectives.at(front[rhs], j);
+    });
+    const double range = objectives.at(front[order.back()], j) -
+            objectives.at(front[order.front()], j);
+    distances[order.front()] = infinity;
+    distances[order.back()] = infinity;
+    if(range <= 0) return;
+    for(size_t k = 1; k + 1 < size; ++k)
+    {
+        distances[order[k]] += (objectives.at(front[order[k + 1]], j) -
+                objectives.at(front[order[k - 1]], j)) / range;
+    }
+}
+
+}
+
+// Crowding distance of every member of a front
+inline std::vector<double>
+crowdingDistance(const ObjectiveMatrix &objectives,
+                 const std::vector<size_t> &front)
+{
+    std::vector<double> distances(front.size(), 0);
+    std::vector<size_t> order;
+    for(size_t j = 0; j < objectives.columns(); ++j)
+    {
+        detail::addCrowding(objectives, front, j, order, distances.data());
+    }
+    return distances;
+}
+
+// Crowding distances of the first count fronts in a single pass, one task
+// per front and objective. Small batches run on the calling thread, where
+// they cost less than starting threads or queueing tasks.
+inline std::vector< std::vector<double> >
+crowdingDistances(const ObjectiveMatrix &objectives,
+                  const std::vector< std::vector<size_t> > &fronts,
+                  size_t count, unsigned int numberOfThreads = 1,
+                  Executor *executor = nullptr)
+{
+    static constexpr size_t parallelThreshold = 4096;
+    const size_t columns = objectives.columns();
+    count = std::min(count, fronts.size());
+    std::vector< std::vector<double> > distances(count);
+    // Every objective sums into its own column, so that tasks don't share
+    // any output
+    std::vector< std::vector<double> > partial(count);
+    size_t work = 0;
+    for(size_t f = 0; f < count; ++f)
+    {
+        partial[f].assign(columns * fronts[f].size(), 0);
+        work += columns * fronts[f].size();
+    }
+    if(work < parallelThreshold)
+    {
+        numberOfThreads = 1;
+        executor = nullptr;
+    }
+    parallelFor(count * columns, numberOfThreads, executor,
+                [&](size_t begin, size_t end) {
+        std::vector<size_t> order;
+        for(size_t task = begin; task < end; ++task)
+        {
+            const size_t f = task / columns;
+            const size_t j = task % columns;
+            detail::addCrowding(objectives, fronts[f], j, order,
+                                &partial[f][j * fronts[f].size()]);
+        }
+    });
+    for(size_t f = 0; f < count; ++f)
+    {
+        const size_t size = fronts[f].size();
+        distances[f].assign(size, 0);
+        for(size_t j = 0; j < columns; ++j)
+        {
+            for(size_t k = 0; k < size; ++k)
+            {
+                distances[f][k] += partial[f][j * size + k];
+            }
+        }
+    }
+    return distances;
+}
+
+// Bounded set of mutually non-dominated organisms. When full, the most
+// crowded member is dropped.
+template<typename GenType>
+class ParetoArchive
+{
+public:
+    ParetoArchive(size_t capacity = 100) : capacity_(capacity) {}
+
+    void clear() { members_.clear(); }
+
+    void insert(const Population<GenType> &population, bool minimize)
+    {
+        if(!capacity_) return;
+        for(const auto &org : population)
+        {
+            if(org.violation <= 0) insert(org, minimize);
+        }
+        if(members_.size() > capacity_) truncate(minimize);
+    }
+
+    const Population<GenType> &members() const { return members_; }
+
+private:
+    size_t capacity_;
+    Population<GenType> members_;
+
+    void insert(const Organism<GenType> &org, bool minimize)
+    {
+        const double sign = (minimize) ? 1 : -1;
+        const size_t size = org.objectives.size();
+        std::vector<double> candidate(size), member(size);
+        for(size_t j = 0; j < size; ++j)
+        {
+            candidate[j] = sign * org.objectives[j];
+        }
+        size_t kept = 0;
+        for(size_t i = 0; i < members_.size(); ++i)
+        {
+            for(size_t j = 0; j < size; ++j)
+            {
+                member[j] = sign * members_[i].objectives[j];
+            }
+            if(dominates(member.data(), candidate.data(), size) ||
+               std::equal(member.begin(), member.end(), candidate.begin()))
+            {
+                return;
+            }
+            if(!dominates(candidate.data(), member.data(), size))
+            {
+                if(kept != i) members_[kept] = std::move(members_[i]);
+                ++kept;
+            }
+        }
+        members_.resize(kept);
+        members_.push_back(org);
+    }
+
+    void truncate(bool minimize)
+    {
+        ObjectiveMatrix objectives;
+        while(members_.size() > capacity_)
+        {
+            objectives.assign(members_, minimize);
+            std::vector<size_t> front(members_.size());
+            std::iota(front.begin(), front.end(), 0);
+            const auto distances = crowdingDistance(objectives, front);
+            const size_t crowded = std::min_element(distances.begin(),
+                                                    distances.end()) -
+                    distances.begin();
+            members_.erase(members_.begin() + crowded);
+        }
+    }
+};
+
+// NSGA-II environmental selection: parents and offspring are merged,
+// sorted into non-dominated fronts and truncated by crowding distance.
+// The fitness of every survivor becomes rank + 0.5 / (1 + crowding), so
+// sorting by fitness yields the NSGA-II order and tournament selection
+// works unchanged. The fitness function must fill Organism::objectives.
+// Constraints use constrained domination: feasible organisms come first
+// and infeasible ones follow, one per rank, by increasing violation.
+template<typename GenType>
+class NSGA2Replacement : public Replacement<GenType>
+{
+public:
+    void setNumberOfThreads(unsigned int numberOfThreads) override
+    {
+        numberOfThreads_ = numberOfThreads;
+    }
+
+    void setExecutor(std::shared_ptr<Executor> executor) override
+    {
+        executor_ = std::move(executor);
+    }
+
+    void initialize(Population<GenType> &population, bool minimize) override
+    {
+        select(population, population.size(), minimize);
+    }
+
+    bool replace(Population<GenType> &population,
+                 Population<GenType> &offspring,
+                 const std::vector<OffspringRecord> &,
+                 bool minimize, std::vector<ReplacementSwap> &) override
+    {
+        const size_t size = population.size();
+        population.reserve(size + offspring.size());
+        std::move(offspring.begin(), offspring.end(),
+                  std::back_inserter(population));
+        select(population, size, minimize);
+        return false;
+    }
+
+private:
+    unsigned int numberOfThreads_ = 1;
+    std::shared_ptr<Executor> executor_;
+    ObjectiveMatrix objectives_;
+
+    void select(Population<GenType> &population, size_t size, bool minimize)
+    {
+        objectives_.assign(population, minimize);
+        const auto fronts = nonDominatedSort(objectives_);
+        // Fronts which contribute survivors
+        size_t needed = 0;
+        for(size_t taken = 0; needed < fronts.size() && taken < size;
+            ++needed)
+        {
+            taken += fronts[needed].size();
+        }
+        const auto crowding = crowdingDistances(objectives_, fronts, needed,
+                                                numberOfThreads_,
+                                                executor_.get());
+        Population<GenType> survivors;
+        survivors.reserve(size);
+        for(size_t rank = 0; rank < needed; ++rank)
+        {
+            const auto &front = fronts[rank];
+            const auto &distances = crowding[rank];
+            std::vector<size_t> order(front.size());
+            std::iota(order.begin(), order.end(), 0);
+            if(survivors.size() + front.size() > size)
+            {
+                std::sort(order.begin(), order.end(),
+                          [&](size_t lhs, size_t rhs) {
+                    return distances[lhs] > distances[rhs];
+                });
+                order.resize(size - survivors.size());
+            }
+            for(size_t k : order)
+            {
+                survivors.push_back(
+                            std::move(population[objectives_.index(front[k])]));
+                const double score = rank + 0.5 / (1 + distances[k]);
+                survivors.back().fitness = (minimize) ? score : -score;
+            }
+        }
+        if(survivors.size() < size)
+        {
+            std::vector<size_t> infeasible;
+            for(size_t i = 0; i < population.size(); ++i)
+            {
+                if(population[i].violation > 0) infeasible.push_back(i);
+            }
+            std::stable_sort(infeasible.begin(), infeasible.end(),
+                             [&](size_t lhs, size_t rhs) {
+                return population[lhs].violation < population[rhs].violation;
+            });
+            infeasible.resize(std::min(infeasible.size(),
+                                       size - survivors.size()));
+            double rank = fronts.size();
+            for(size_t i : infeasible)
+            {
+                survivors.push_back(std::move(population[i]));
+                survivors.back().fitness = (minimize) ? rank : -rank;
+                ++rank;
+            }
+        }
+        population = std::move(survivors);
+    }
+};
+
+}
+
+#endif // MULTIOBJECTIVE_H
@@ -2,7 +2,9 @@
 #define MUTATION_H
 
 #include "organism.h"
+#include "gene.h"
 #include "geneticalgorithm.h"
+#include <algorithm>
 #include <random>
 
 namespace ga
@@ -13,6 +15,8 @@ class Mutation
 {
 public:
     virtual void mutation(std::vector<GenType> &) = 0;
+    // Multiplier for the mutation step size, used by adaptation
+    virtual void setStepScale(double) {}
     virtual ~Mutation() = default;
 };
 
@@ -21,6 +25,8 @@ class GaussianMutation : public Mutation<GenType>
 {
 public:
     GaussianMutation(double deviation, double mean = 0) :
+        deviation_(deviation),
+        mean_(mean),
         distribution_(mean, deviation)
     {
         static_assert(!std::is_same<GenType, bool>::value,
@@ -30,21 +36,29 @@ public:
     {
         for(size_t i = 0; i < chromosome.size(); ++i)
         {
-            chromosome[i] += distribution_(generator_);
+            chromosome[i] = toGene<GenType>(chromosome[i] +
+                                            distribution_(generator_));
         }
     }
+    void setStepScale(double scale) override
+    {
+        distribution_ = std::normal_distribution< GeneReal<GenType> >(
+                    mean_, deviation_ * scale);
+    }
 
 private:
+    const double deviation_;
+    const double mean_;
     std::default_random_engine generator_;
-    std::normal_distribution<GenType> distribution_;
+    std::normal_distribution< GeneReal<GenType> > distribution_;
 };
 
 template<typename GenType>
 class UniformMutation : public Mutation<GenType>
 {
 public:
-    UniformMutation(size_t quantity = 1, double max = 1, double min = 0) :
-        quantity_(quantity), max_(max), min_(min)
+    UniformMutation(size_t quantity = 1, GenType max = 1, GenType min = 0) :
+        quantity_(quantity), distribution_(min, max)
     {
         static_assert(!std::is_same<GenType, bool>::value,
                       "UniformMutation doesn't work with binary encoding!");
@@ -52,17 +66,17 @@ public:
 
     void mutation(std::vector<GenType> &chromosome) override
     {
-        for(size_t i = 0; i < quantity_; ++i)
+        const size_t count = std::min(quantity_, chromosome.size());
+        for(size_t i = 0; i < count; ++i)
         {
-            chromosome[i] = min_ + static_cast<double>(rand()) /
-                    (static_cast<double>(RAND_MAX / (max_ - min_)));
+            chromosome[i] = static_cast<GenType>(distribution_(generator_));
         }
     }
 
 private:
     size_t quantity_;
-    double max_;
-    double min_;
+    std::default_random_engine generator_;
+    GeneUniformDistribution<GenType> distribution_;
 };
 
 // Only for binary chromosomes (bool)
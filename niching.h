@@ -0,0 +1,408 @@
+#ifndef NICHING_H
+#define NICHING_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <unordered_map>
+#include <vector>
+#include "organism.h"
+#include "fitnesscaling.h"
+#include "replacement.h"
+#include "geneticalgorithm.h"
+
+namespace ga
+{
+
+// Euclidean distance for real chromosomes
+template<typename GenType>
+double distance(const std::vector<GenType> &lhs,
+                const std::vector<GenType> &rhs)
+{
+    double sum = 0;
+    for(size_t i = 0; i < lhs.size(); ++i)
+    {
+        const double delta = static_cast<double>(lhs[i]) -
+                static_cast<double>(rhs[i]);
+        sum += delta * delta;
+    }
+    return std::sqrt(sum);
+}
+
+// Hamming distance for binary chromosomes
+inline double distance(const std::vector<bool> &lhs,
+                       const std::vector<bool> &rhs)
+{
+    size_t count = 0;
+    for(size_t i = 0; i < lhs.size(); ++i)
+    {
+        count += lhs[i] != rhs[i];
+    }
+    return count;
+}
+
+// Hash grid over the first few coordinates of real chromosomes. Cells are
+// as wide as the query radius, so all neighbors of a point are found in
+// the 3^k surrounding cells and then filtered by the exact distance.
+template<typename GenType>
+class GridIndex
+{
+public:
+    GridIndex(size_t dimensions = 3) : dimensions_(dimensions) {}
+
+    void build(const Population<GenType> &population, double radius)
+    {
+        population_ = &population;
+        cellSize_ = (radius > 0) ? radius : 1;
+        cells_.clear();
+        if(population.empty()) return;
+        used_ = std::min(dimensions_, population.front().chromosome.size());
+        cells_.reserve(population.size());
+        std::vector<int64_t> cell(used_);
+        for(size_t i = 0; i < population.size(); ++i)
+        {
+            locate(population[i].chromosome, cell);
+            cells_[hash(cell)].push_back(i);
+        }
+    }
+
+    // Adds an organism appended to the indexed population after build()
+    void insert(size_t index)
+    {
+        std::vector<int64_t> cell(used_);
+        locate((*population_)[index].chromosome, cell);
+        cells_[hash(cell)].push_back(index);
+    }
+
+    // Calls visitor(index, distance) for every organism within radius
+    template<typename Visitor>
+    void forEachNeighbor(const std::vector<GenType> &point, double radius,
+                         Visitor visitor) const
+    {
+        if(cells_.empty()) return;
+        std::vector<int64_t> center(used_), cell(used_);
+        locate(point, center);
+        const int64_t reach =
+                static_cast<int64_t>(std::ceil(radius / cellSize_));
+        cell = center;
+        for(size_t i = 0; i < used_; ++i) cell[i] -= reach;
+        while(true)
+        {
+            const auto found = cells_.find(hash(cell));
+            if(found != cells_.end())
+            {
+                for(size_t index : found->second)
+                {
+                    const double d =
+                            distance(point, (*population_)[index].chromosome);
+                    if(d <= radius) visitor(index, d);
+                }
+            }
+            size_t i = 0;
+            for(; i < used_; ++i)
+            {
+                if(cell[i] < center[i] + reach)
+                {
+                    ++cell[i];
+                    break;
+                }
+                cell[i] = center[i] - reach;
+            }
+            if(i == used_) break;
+        }
+    }
+
+private:
+    const size_t dimensions_;
+    size_t used_ = 0;
+    double cellSize_ = 1;
+    const Population<GenType> *population_ = nullptr;
+    std::unordered_map< uint64_t, std::vector<size_t> > cells_;
+
+    void locate(const std::vector<GenType> &point,
+                std::vector<int64_t> &cell) const
+    {
+        for(size_t i = 0; i < used_; ++i)
+        {
+            cell[i] = static_cast<int64_t>(
+                        std::floor(static_cast<double>(point[i]) / cellSize_));
+        }
+    }
+
+    static uint64_t hash(const std::vector<int64_t> &cell)
+    {
+        uint64_t hash = 1469598103934665603ULL;
+        for(int64_t coordinate : cell)
+        {
+            hash ^= static_cast<uint64_t>(coordinate);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+};
+
+// Bit-sampling locality sensitive hashing for binary chromosomes. Every
+// table keys organisms by a random subset of bits; close organisms are
+// likely to share a bucket in at least one table.
+class LSHIndex
+{
+public:
+    LSHIndex(size_t tables = 8, size_t bits = 12) :
+        tables_(tables), bits_(bits), gen_(std::random_device()()) {}
+
+    void build(const Population<bool> &population, double)
+    {
+        population_ = &population;
+        buckets_.assign(tables_, {});
+        samples_.assign(tables_, {});
+        if(population.empty()) return;
+        const size_t size = population.front().chromosome.size();
+        std::uniform_int_distribution<size_t> position(0, size - 1);
+        for(size_t t = 0; t < tables_; ++t)
+        {
+            samples_[t].resize(std::min(bits_, size));
+            for(auto &bit : samples_[t]) bit = position(gen_);
+            for(size_t i = 0; i < population.size(); ++i)
+            {
+                buckets_[t][key(t, population[i].chromosome)].push_back(i);
+            }
+        }
+        visited_.assign(population.size(), 0);
+        stamp_ = 0;
+    }
+
+    // Adds an organism appended to the indexed population after build()
+    void insert(size_t index)
+    {
+        const auto &chromosome = (*population_)[index].chromosome;
+        for(size_t t = 0; t < tables_; ++t)
+        {
+            buckets_[t][key(t, chromosome)].push_back(index);
+        }
+        visited_.resize(population_->size(), 0);
+    }
+
+    template<typename Visitor>
+    void forEachNeighbor(const std::vector<bool> &point, double radius,
+                         Visitor visitor) const
+    {
+        if(!population_ || population_->empty()) return;
+        ++stamp_;
+        for(size_t t = 0; t < tables_; ++t)
+        {
+            const auto found = buckets_[t].find(key(t, point));
+            if(found == buckets_[t].end()) continue;
+            for(size_t index : found->second)
+            {
+                if(visited_[index] == stamp_) continue;
+                visited_[index] = stamp_;
+                const double d =
+                        distance(point, (*population_)[index].chromosome);
+                if(d <= radius) visitor(index, d);
+            }
+        }
+    }
+
+private:
+    const size_t tables_;
+    const size_t bits_;
+    std::mt19937_64 gen_;
+    const Population<bool> *population_ = nullptr;
+    std::vector< std::vector<size_t> > samples_;
+    std::vector< std::unordered_map< uint64_t, std::vector<size_t> > >
+    buckets_;
+    mutable std::vector<unsigned long> visited_;
+    mutable unsigned long stamp_ = 0;
+
+    uint64_t key(size_t table, const std::vector<bool> &chromosome) const
+    {
+        uint64_t key = 0;
+        for(size_t bit : samples_[table])
+        {
+            key = (key << 1) ^ chromosome[bit] ^ (key >> 63);
+        }
+        return key;
+    }
+};
+
+template<typename GenType>
+struct NeighborIndex
+{
+    using type = GridIndex<GenType>;
+};
+
+template<>
+struct NeighborIndex<bool>
+{
+    using type = LSHIndex;
+};
+
+// Fitness sharing: fitness is divided by the niche count
+// sum(1 - (d / radius)^alpha) over all neighbors within radius.
+// Expects a sorted population.
+template<typename GenType>
+class SharingScaling : public FitnessScaling<GenType>
+{
+public:
+    SharingScaling(double radius, double alpha = 1) :
+        radius_(radius), alpha_(alpha) {}
+    void scale(Population<GenType> &population, bool minimize) override
+    {
+        if(population.empty()) return;
+        index_.build(population, radius_);
+        // Goodness is positive and larger for better organisms
+        const double worst = population.back().fitness;
+        const double range = std::abs(population.front().fitness - worst);
+        const double offset = (range > 0) ? range * 1e-3 : 1;
+        std::vector<double> shared(population.size());
+        for(size_t i = 0; i < population.size(); ++i)
+        {
+            double count = 0;
+            index_.forEachNeighbor(population[i].chromosome, radius_,
+                                   [&](size_t, double d) {
+                count += 1 - std::pow(d / radius_, alpha_);
+            });
+            const double goodness =
+                    std::abs(population[i].fitness - worst) + offset;
+            shared[i] = goodness / std::max(count, 1.0);
+        }
+        for(size_t i = 0; i < population.size(); ++i)
+        {
+            population[i].fitness = (minimize) ? -shared[i] : shared[i];
+        }
+    }
+
+private:
+    const double radius_;
+    const double alpha_;
+    typename NeighborIndex<GenType>::type index_;
+};
+
+// Clearing: only the best `capacity` organisms of every niche keep their
+// fitness, the others get the worst possible one. Expects a sorted
+// population.
+template<typename GenType>
+class ClearingScaling : public FitnessScaling<GenType>
+{
+public:
+    ClearingScaling(double radius, size_t capacity = 1) :
+        radius_(radius), capacity_(capacity) {}
+    void scale(Population<GenType> &population, bool minimize) override
+    {
+        const double cleared = (minimize) ?
+                    std::numeric_limits<double>::max() :
+                    std::numeric_limits<double>::lowest();
+        index_.build(population, radius_);
+        std::vector<bool> removed(population.size(), false);
+        for(size_t i = 0; i < population.size(); ++i)
+        {
+            if(removed[i]) continue;
+            size_t winners = 1;
+            index_.forEachNeighbor(population[i].chromosome, radius_,
+                                   [&](size_t j, double) {
+                if(j <= i || removed[j]) return;
+                if(winners < capacity_) ++winners;
+                else removed[j] = true;
+            });
+        }
+        for(size_t i = 0; i < population.size(); ++i)
+        {
+            if(removed[i]) population[i].fitness = cleared;
+        }
+    }
+
+private:
+    const double radius_;
+    const size_t capacity_;
+    typename NeighborIndex<GenType>::type index_;
+};
+
+// Deterministic crowding: every offspring competes with the more similar
+// of its parents and the better of the two survives
+template<typename GenType>
+class DeterministicCrowding : public Replacement<GenType>
+{
+public:
+    bool replace(Population<GenType> &population,
+                 Population<GenType> &offspring,
+                 const std::vector<OffspringRecord> &records,
+                 bool minimize, std::vector<ReplacementSwap> &) override
+    {
+        for(size_t i = 0; i < offspring.size(); ++i)
+        {
+            const OffspringRecord &record = records[i];
+            if(record.crossover == OffspringRecord::none) continue;
+            const Organism<GenType> &first = population[record.first];
+            const Organism<GenType> &second = population[record.second];
+            if(i + 1 < offspring.size() && sameParents(record, records[i + 1]))
+            {
+                // Pair both children with the parents so that the total
+                // distance is minimal
+                Organism<GenType> &lhs = offspring[i];
+                Organism<GenType> &rhs = offspring[i + 1];
+                const bool straight =
+                        distance(first.chromosome, lhs.chromosome) +
+                        distance(second.chromosome, rhs.chromosome) <=
+                        distance(first.chromosome, rhs.chromosome) +
+                        distance(second.chromosome, lhs.chromosome);
+                compete(straight ? first : second, lhs, minimize);
+                compete(straight ? second : first, rhs, minimize);
+                ++i;
+            }
+            else
+            {
+                Organism<GenType> &child = offspring[i];
+                const bool closerFirst =
+                        distance(first.chromosome, child.chromosome) <=
+                        distance(second.chromosome, child.chromosome);
+                compete(closerFirst ? first : second, child, minimize);
+            }
+        }
+        population = std::move(offspring);
+        return false;
+    }
+
+private:
+    static bool sameParents(const OffspringRecord &lhs,
+                            const OffspringRecord &rhs)
+    {
+        return lhs.first == rhs.first && lhs.second == rhs.second &&
+                lhs.crossover == rhs.crossover;
+    }
+
+    static void compete(const Organism<GenType> &parent,
+                        Organism<GenType> &child, bool minimize)
+    {
+        if(minimize ? parent.fitness < child.fitness :
+                      parent.fitness > child.fitness)
+        {
+            child = parent;
+        }
+    }
+};
+
+// Picks the best organism of every niche from a sorted population
+template<typename GenType>
+Population<GenType> distinctOptima(const Population<GenType> &population,
+                                   double radius, size_t maxCount = 0)
+{
+    Population<GenType> optima;
+    typename NeighborIndex<GenType>::type index;
+    index.build(population, radius);
+    std::vector<bool> covered(population.size(), false);
+    for(size_t i = 0; i < population.size(); ++i)
+    {
+        if(covered[i]) continue;
+        optima.push_back(population[i]);
+        if(maxCount && optima.size() >= maxCount) break;
+        index.forEachNeighbor(population[i].chromosome, radius,
+                              [&](size_t j, double) { covered[j] = true; });
+    }
+    return optima;
+}
+
+}
+
+#endif // NICHING_H
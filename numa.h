@@ -0,0 +1,275 @@
+#ifndef NUMA_H
+#define NUMA_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "parallel.h"
+
+#ifdef __linux__
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace ga
+{
+
+// CPUs of every NUMA node usable by the process, read from sysfs. Machines
+// without NUMA information are reported as a single node.
+class NumaTopology
+{
+public:
+    NumaTopology()
+    {
+        const std::vector<int> allowed = allowedCpus();
+#ifdef __linux__
+        const std::string root = "/sys/devices/system/node/";
+        std::vector<int> ids;
+        if(DIR *directory = opendir(root.c_str()))
+        {
+            while(const dirent *entry = readdir(directory))
+            {
+                const std::string name = entry->d_name;
+                if(name.compare(0, 4, "node") != 0 || name.size() == 4 ||
+                   name.find_first_not_of("0123456789", 4) !=
+                   std::string::npos)
+                {
+                    continue;
+                }
+                ids.push_back(std::atoi(name.c_str() + 4));
+            }
+            closedir(directory);
+        }
+        std::sort(ids.begin(), ids.end());
+        for(int id : ids)
+        {
+            std::ifstream file(root + "node" + std::to_string(id) +
+                               "/cpulist");
+            std::string list;
+            std::getline(file, list);
+            std::vector<int> cpus;
+            for(int cpu : parseList(list))
+            {
+                if(std::binary_search(allowed.begin(), allowed.end(), cpu))
+                {
+                    cpus.push_back(cpu);
+                }
+            }
+            // Memory-only nodes and nodes outside of the cpuset
+            if(!cpus.empty()) nodes_.push_back(cpus);
+        }
+#endif
+        if(nodes_.empty()) nodes_.push_back(allowed);
+    }
+
+    size_t nodes() const
+    {
+        return nodes_.size();
+    }
+
+    const std::vector<int> &cpus(size_t node) const
+    {
+        return nodes_[node];
+    }
+
+    // Parses lists like "0-3,8,10-11"
+    static std::vector<int> parseList(const std::string &list)
+    {
+        std::vector<int> values;
+        std::stringstream stream(list);
+        std::string range;
+        while(std::getline(stream, range, ','))
+        {
+            if(range.find_first_of("0123456789") == std::string::npos)
+            {
+                continue;
+            }
+            const size_t dash = range.find('-');
+            const int first = std::atoi(range.c_str());
+            const int last = (dash == std::string::npos) ? first :
+                                 std::atoi(range.c_str() + dash + 1);
+            for(int value = first; value <= last; ++value)
+            {
+                values.push_back(value);
+            }
+        }
+        return values;
+    }
+
+private:
+    std::vector< std::vector<int> > nodes_;
+
+    static std::vector<int> allowedCpus()
+    {
+        std::vector<int> cpus;
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if(sched_getaffinity(0, sizeof(set), &set) == 0)
+        {
+            for(int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            {
+                if(CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+            }
+        }
+#endif
+        if(cpus.empty())
+        {
+            const int count = std::max(std::thread::hardware_concurrency(),
+                                       1u);
+            for(int cpu = 0; cpu < count; ++cpu) cpus.push_back(cpu);
+        }
+        return cpus;
+    }
+};
+
+// Executor with a persistent pool of workers spread over the NUMA nodes
+// and optionally pinned to their CPUs, so that evaluation threads neither
+// start per batch nor migrate. Batches are split statically, worker k
+// always gets the k-th slice of [0, count).
+//
+// Only threads are placed. Offspring are bred, and so allocated, on the
+// engine's thread, so gene memory isn't local to the workers' nodes.
+class PinnedExecutor : public Executor
+{
+public:
+    // Zero workers per node uses every CPU of each node
+    explicit PinnedExecutor(unsigned int workersPerNode = 0, bool pin = true)
+    {
+        const NumaTopology topology;
+        for(size_t node = 0; node < topology.nodes(); ++node)
+        {
+            const std::vector<int> &cpus = topology.cpus(node);
+            const size_t count = (workersPerNode) ? workersPerNode :
+                                                    cpus.size();
+            for(size_t i = 0; i < count; ++i)
+            {
+                placement_.push_back({node, cpus[i % cpus.size()]});
+            }
+        }
+        nodes_ = topology.nodes();
+        for(size_t i = 0; i < placement_.size(); ++i)
+        {
+            threads_.emplace_back(&PinnedExecutor::work, this, i, pin);
+        }
+    }
+    PinnedExecutor(const PinnedExecutor &) = delete;
+    PinnedExecutor &operator=(const PinnedExecutor &) = delete;
+
+    ~PinnedExecutor()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        start_.notify_all();
+        for(auto &thread : threads_) thread.join();
+    }
+
+    unsigned int workers() const
+    {
+        return static_cast<unsigned int>(placement_.size());
+    }
+
+    size_t nodes() const
+    {
+        return nodes_;
+    }
+
+    void parallelFor(
+            size_t count,
+            const std::function<void(size_t, size_t)> &function) override
+    {
+        if(!count) return;
+        // Engines sharing the executor take turns
+        std::lock_guard<std::mutex> batch(batchMutex_);
+        std::unique_lock<std::mutex> lock(mutex_);
+        function_ = &function;
+        count_ = count;
+        remaining_ = placement_.size();
+        error_ = nullptr;
+        ++batch_;
+        start_.notify_all();
+        done_.wait(lock, [this]() { return !remaining_; });
+        function_ = nullptr;
+        if(error_) std::rethrow_exception(error_);
+    }
+
+private:
+    struct Placement
+    {
+        size_t node;
+        int cpu;
+    };
+
+    size_t nodes_ = 0;
+    std::vector<Placement> placement_;
+    std::vector<std::thread> threads_;
+
+    std::mutex batchMutex_;
+    std::mutex mutex_;
+    std::condition_variable start_;
+    std::condition_variable done_;
+    const std::function<void(size_t, size_t)> *function_ = nullptr;
+    size_t count_ = 0;
+    size_t remaining_ = 0;
+    unsigned long batch_ = 0;
+    std::exception_ptr error_;
+    bool stop_ = false;
+
+    void work(size_t index, bool pin)
+    {
+#ifdef __linux__
+        if(pin)
+        {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(placement_[index].cpu, &set);
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        }
+#else
+        (void)pin;
+#endif
+        const size_t workers = placement_.size();
+        unsigned long seen = 0;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while(true)
+        {
+            start_.wait(lock, [&]() { return stop_ || batch_ != seen; });
+            if(stop_) return;
+            seen = batch_;
+            const auto &function = *function_;
+            const size_t begin = count_ * index / workers;
+            const size_t end = count_ * (index + 1) / workers;
+            lock.unlock();
+            std::exception_ptr failure;
+            if(begin < end)
+            {
+                try
+                {
+                    function(begin, end);
+                }
+                catch(...)
+                {
+                    failure = std::current_exception();
+                }
+            }
+            lock.lock();
+            if(failure && !error_) error_ = failure;
+            if(!--remaining_) done_.notify_one();
+        }
+    }
+};
+
+}
+
+#endif // NUMA_H
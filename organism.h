@@ -39,11 +39,36 @@ struct Organism
 
     std::vector<GenType> chromosome;
     double fitness;
+    // Filled by the fitness function in multi-objective mode
+    std::vector<double> objectives;
+    // Total constraint violation, 0 for feasible organisms
+    double violation = 0;
 };
 
 template<typename T>
 using Population = std::vector<Organism<T>>;
 
+// Origin of an organism in the next population: indices of its parents in
+// the current population and the crossover operator which produced it
+struct OffspringRecord
+{
+    static constexpr size_t none = static_cast<size_t>(-1);
+
+    size_t first = none;
+    size_t second = none;
+    size_t crossover = none;
+    bool mutated = false;
+};
+
+// Organism handed out for evaluation by an ask/tell driven engine, it is
+// told back with the fitness (and objectives) filled in
+template<typename GenType>
+struct Candidate
+{
+    size_t id;
+    Organism<GenType> organism;
+};
+
 }
 
 #endif // ORGANISM_H
@@ -0,0 +1,68 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace ga
+{
+
+// Splits [0, count) into contiguous chunks and calls function(begin, end)
+// for each of them on its own thread. The last chunk runs on the calling
+// thread.
+template<typename Function>
+void parallelFor(size_t count, unsigned int numberOfThreads,
+                 Function function)
+{
+    numberOfThreads = static_cast<unsigned int>(
+                std::min<size_t>(numberOfThreads, count));
+    if(numberOfThreads <= 1)
+    {
+        function(static_cast<size_t>(0), count);
+        return;
+    }
+    const size_t step = count / numberOfThreads;
+    std::vector<std::thread> threads;
+    threads.reserve(numberOfThreads - 1);
+    size_t currentPosition = 0;
+    for(unsigned int i = 0; i < (numberOfThreads - 1); ++i)
+    {
+        threads.emplace_back(function, currentPosition,
+                             currentPosition + step);
+        currentPosition += step;
+    }
+    function(currentPosition, count);
+    for(auto &thread : threads)
+    {
+        thread.join();
+    }
+}
+
+// Runs evaluation batches of an engine somewhere else than on threads of
+// its own, e.g. on a worker pool shared by many engines
+class Executor
+{
+public:
+    // Calls function(begin, end) over a partition of [0, count) and returns
+    // when all calls are done
+    virtual void parallelFor(
+            size_t count,
+            const std::function<void(size_t, size_t)> &function) = 0;
+    virtual ~Executor() = default;
+};
+
+// Runs on the executor if there is one, otherwise on numberOfThreads
+// threads of the caller
+template<typename Function>
+void parallelFor(size_t count, unsigned int numberOfThreads,
+                 Executor *executor, Function function)
+{
+    if(executor) executor->parallelFor(count, function);
+    else parallelFor(count, numberOfThreads, function);
+}
+
+}
+
+#endif // PARALLEL_H
@@ -0,0 +1,246 @@
+#ifndef REPLACEMENT_H
+#define REPLACEMENT_H
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <vector>
+#include "organism.h"
+#include "parallel.h"
+#include "geneticalgorithm.h"
+
+namespace ga
+{
+
+// Offspring which a replacement swapped into the population: the organism
+// at population[slot] went to offspring[child] and vice versa
+struct ReplacementSwap
+{
+    size_t slot;
+    size_t child;
+};
+
+// Builds the next population from the current one and the evaluated
+// offspring. Without a replacement strategy the offspring simply replace
+// the whole population.
+template<typename GenType>
+class Replacement
+{
+public:
+    virtual void setNumberOfThreads(unsigned int) {}
+    virtual void setExecutor(std::shared_ptr<Executor>) {}
+    // Called once for the evaluated initial population
+    virtual void initialize(Population<GenType> &, bool) {}
+    // Offspring bred (and evaluated) per generation, prepopulated ones
+    // included
+    virtual size_t offspringCount(size_t populationSize) const
+    {
+        return populationSize;
+    }
+    // Whether the prepopulated organisms (e.g. elites) join the offspring,
+    // strategies which keep the best parents by themselves leave them out
+    virtual bool usesPrepopulation() const
+    {
+        return true;
+    }
+    // Returns true if the population only changed by the swaps appended
+    // to swaps, false if it was rebuilt
+    virtual bool replace(Population<GenType> &population,
+                         Population<GenType> &offspring,
+                         const std::vector<OffspringRecord> &records,
+                         bool minimize,
+                         std::vector<ReplacementSwap> &swaps) = 0;
+    virtual ~Replacement() = default;
+
+protected:
+    static bool better(const Organism<GenType> &lhs,
+                       const Organism<GenType> &rhs, bool minimize)
+    {
+        return (minimize) ? lhs.fitness < rhs.fitness :
+                            lhs.fitness > rhs.fitness;
+    }
+};
+
+// (mu + lambda): parents and offspring compete, the best mu survive
+template<typename GenType>
+class PlusReplacement : public Replacement<GenType>
+{
+public:
+    // Zero lambda breeds as many offspring as there are parents
+    explicit PlusReplacement(size_t lambda = 0) : lambda_(lambda) {}
+
+    size_t offspringCount(size_t populationSize) const override
+    {
+        return (lambda_) ? lambda_ : populationSize;
+    }
+
+    bool usesPrepopulation() const override
+    {
+        return false;
+    }
+
+    bool replace(Population<GenType> &population,
+                 Population<GenType> &offspring,
+                 const std::vector<OffspringRecord> &,
+                 bool minimize, std::vector<ReplacementSwap> &) override
+    {
+        const size_t size = population.size();
+        population.reserve(size + offspring.size());
+        std::move(offspring.begin(), offspring.end(),
+                  std::back_inserter(population));
+        std::nth_element(population.begin(), population.begin() + size,
+                         population.end(),
+                         [minimize](const Organism<GenType> &lhs,
+                                    const Organism<GenType> &rhs) {
+            return Replacement<GenType>::better(lhs, rhs, minimize);
+        });
+        population.erase(population.begin() + size, population.end());
+        return false;
+    }
+
+private:
+    const size_t lambda_;
+};
+
+// (mu, lambda): the parents die, the best mu of lambda >= mu offspring
+// survive
+template<typename GenType>
+class CommaReplacement : public Replacement<GenType>
+{
+public:
+    // Zero lambda breeds as many offspring as there are parents
+    explicit CommaReplacement(size_t lambda = 0) : lambda_(lambda) {}
+
+    size_t offspringCount(size_t populationSize) const override
+    {
+        return std::max(lambda_, populationSize);
+    }
+
+    bool replace(Population<GenType> &population,
+                 Population<GenType> &offspring,
+                 const std::vector<OffspringRecord> &,
+                 bool minimize, std::vector<ReplacementSwap> &) override
+    {
+        const size_t size = std::min(population.size(), offspring.size());
+        std::nth_element(offspring.begin(), offspring.begin() + size,
+                         offspring.end(),
+                         [minimize](const Organism<GenType> &lhs,
+                                    const Organism<GenType> &rhs) {
+            return Replacement<GenType>::better(lhs, rhs, minimize);
+        });
+        std::swap_ranges(offspring.begin(), offspring.begin() + size,
+                         population.begin());
+        return false;
+    }
+
+private:
+    const size_t lambda_;
+};
+
+// Generation gap: only a fraction of the population is bred each
+// generation and the offspring take the places of the worst organisms
+template<typename GenType>
+class GenerationGapReplacement : public Replacement<GenType>
+{
+public:
+    explicit GenerationGapReplacement(double gap = 0.5) : gap_(gap) {}
+
+    size_t offspringCount(size_t populationSize) const override
+    {
+        const size_t count = static_cast<size_t>(
+                    std::ceil(gap_ * populationSize));
+        return std::min(std::max<size_t>(count, 1), populationSize);
+    }
+
+    bool usesPrepopulation() const override
+    {
+        return false;
+    }
+
+    bool replace(Population<GenType> &population,
+                 Population<GenType> &offspring,
+                 const std::vector<OffspringRecord> &,
+                 bool minimize,
+                 std::vector<ReplacementSwap> &swaps) override
+    {
+        const size_t count = std::min(population.size(), offspring.size());
+        order_.resize(population.size());
+        std::iota(order_.begin(), order_.end(), 0);
+        // Worst organisms first
+        std::nth_element(order_.begin(), order_.begin() + count,
+                         order_.end(), [&](size_t lhs, size_t rhs) {
+            return Replacement<GenType>::better(population[rhs],
+                                                population[lhs], minimize);
+        });
+        for(size_t k = 0; k < count; ++k)
+        {
+            std::swap(population[order_[k]], offspring[k]);
+            swaps.push_back({order_[k], k});
+        }
+        return true;
+    }
+
+private:
+    const double gap_;
+    std::vector<size_t> order_;
+};
+
+// Steady state: a few offspring are bred each generation and every one
+// replaces the worst organism of the population if it is better
+template<typename GenType>
+class SteadyStateReplacement : public Replacement<GenType>
+{
+public:
+    explicit SteadyStateReplacement(size_t count = 1) :
+        count_(std::max<size_t>(count, 1)) {}
+
+    size_t offspringCount(size_t populationSize) const override
+    {
+        return std::min(count_, populationSize);
+    }
+
+    bool usesPrepopulation() const override
+    {
+        return false;
+    }
+
+    bool replace(Population<GenType> &population,
+                 Population<GenType> &offspring,
+                 const std::vector<OffspringRecord> &,
+                 bool minimize,
+                 std::vector<ReplacementSwap> &swaps) override
+    {
+        // Heap of the population with the worst organism on top
+        auto worse = [&](size_t lhs, size_t rhs) {
+            return Replacement<GenType>::better(population[lhs],
+                                                population[rhs], minimize);
+        };
+        heap_.resize(population.size());
+        std::iota(heap_.begin(), heap_.end(), 0);
+        std::make_heap(heap_.begin(), heap_.end(), worse);
+        for(size_t k = 0; k < offspring.size(); ++k)
+        {
+            const size_t worst = heap_.front();
+            if(!Replacement<GenType>::better(offspring[k], population[worst],
+                                             minimize))
+            {
+                continue;
+            }
+            std::pop_heap(heap_.begin(), heap_.end(), worse);
+            std::swap(population[worst], offspring[k]);
+            std::push_heap(heap_.begin(), heap_.end(), worse);
+            swaps.push_back({worst, k});
+        }
+        return true;
+    }
+
+private:
+    const size_t count_;
+    std::vector<size_t> heap_;
+};
+
+}
+
+#endif // REPLACEMENT_H
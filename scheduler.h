@@ -0,0 +1,288 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "parallel.h"
+
+namespace ga
+{
+
+// Runs many optimization jobs on one worker pool. A job is a callable
+// taking the executor which it should install into its engine(s) with
+// setExecutor(); its result is delivered through a future.
+//
+// Jobs are started in priority order on a limited number of job threads,
+// which only drive their engines: evaluation batches are split into tasks
+// and run by the pool workers. Workers always take a task from the highest
+// priority job with queued work and, among those, from the one which has
+// received the least worker time relative to its share, so every running
+// job keeps making progress at generation granularity.
+class Scheduler
+{
+public:
+    // Zero active jobs selects twice the number of workers
+    Scheduler(unsigned int workers = std::thread::hardware_concurrency(),
+              unsigned int activeJobs = 0) :
+        workers_(std::max(workers, 1u))
+    {
+        if(!activeJobs) activeJobs = 2 * workers_;
+        for(unsigned int i = 0; i < workers_; ++i)
+        {
+            threads_.emplace_back(&Scheduler::work, this);
+        }
+        for(unsigned int i = 0; i < activeJobs; ++i)
+        {
+            drivers_.emplace_back(&Scheduler::drive, this);
+        }
+    }
+    Scheduler(const Scheduler &) = delete;
+    Scheduler &operator=(const Scheduler &) = delete;
+
+    // Finishes all submitted jobs
+    ~Scheduler()
+    {
+        {
+            std::lock_guard<std::mutex> lock(jobMutex_);
+            stopJobs_ = true;
+        }
+        jobAvailable_.notify_all();
+        for(auto &thread : drivers_) thread.join();
+        {
+            std::lock_guard<std::mutex> lock(taskMutex_);
+            stopWorkers_ = true;
+        }
+        taskAvailable_.notify_all();
+        for(auto &thread : threads_) thread.join();
+    }
+
+    unsigned int workers() const
+    {
+        return workers_;
+    }
+
+    // Higher priorities are served first, jobs of equal priority split the
+    // workers in proportion to their share
+    template<typename Job>
+    auto submit(Job job, int priority = 0, double share = 1)
+    -> std::future<decltype(job(std::declval<
+                                const std::shared_ptr<Executor> &>()))>
+    {
+        using Result = decltype(job(std::declval<
+                                    const std::shared_ptr<Executor> &>()));
+        auto task = std::make_shared<
+                std::packaged_task<Result(const std::shared_ptr<Executor> &)>
+                >(std::move(job));
+        auto future = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(jobMutex_);
+            pending_.push({priority, sequence_++, std::max(share, 1e-9),
+                           [task](const std::shared_ptr<Executor> &executor) {
+                               (*task)(executor);
+                           }});
+        }
+        jobAvailable_.notify_one();
+        return future;
+    }
+
+private:
+    struct Account
+    {
+        int priority;
+        double share;
+        // Worker time received divided by the share
+        double virtualTime = 0;
+        std::deque< std::function<void()> > tasks;
+    };
+
+    struct PendingJob
+    {
+        int priority;
+        unsigned long sequence;
+        double share;
+        std::function<void(const std::shared_ptr<Executor> &)> run;
+
+        // Orders the queue by priority, then by submission
+        friend bool operator<(const PendingJob &lhs, const PendingJob &rhs)
+        {
+            if(lhs.priority != rhs.priority)
+            {
+                return lhs.priority < rhs.priority;
+            }
+            return lhs.sequence > rhs.sequence;
+        }
+    };
+
+    class JobExecutor : public Executor
+    {
+    public:
+        JobExecutor(Scheduler &scheduler, std::shared_ptr<Account> account) :
+            scheduler_(scheduler), account_(std::move(account)) {}
+
+        void parallelFor(
+                size_t count,
+                const std::function<void(size_t, size_t)> &function) override
+        {
+            if(!count) return;
+            // A few tasks per worker so that shares are kept at a finer
+            // grain than whole batches
+            const size_t chunks = std::min<size_t>(count,
+                                                   4 * scheduler_.workers_);
+            std::mutex mutex;
+            std::condition_variable done;
+            size_t remaining = chunks;
+            std::exception_ptr error;
+            std::vector< std::function<void()> > tasks;
+            tasks.reserve(chunks);
+            for(size_t c = 0; c < chunks; ++c)
+            {
+                const size_t begin = count * c / chunks;
+                const size_t end = count * (c + 1) / chunks;
+                tasks.emplace_back([&, begin, end]() {
+                    std::exception_ptr failure;
+                    try
+                    {
+                        function(begin, end);
+                    }
+                    catch(...)
+                    {
+                        failure = std::current_exception();
+                    }
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if(failure && !error) error = failure;
+                    if(!--remaining) done.notify_one();
+                });
+            }
+            scheduler_.enqueue(account_, tasks);
+            std::unique_lock<std::mutex> lock(mutex);
+            done.wait(lock, [&]() { return !remaining; });
+            if(error) std::rethrow_exception(error);
+        }
+
+    private:
+        Scheduler &scheduler_;
+        std::shared_ptr<Account> account_;
+    };
+
+    const unsigned int workers_;
+    std::vector<std::thread> threads_;
+    std::vector<std::thread> drivers_;
+
+    std::mutex jobMutex_;
+    std::condition_variable jobAvailable_;
+    std::priority_queue<PendingJob> pending_;
+    unsigned long sequence_ = 0;
+    bool stopJobs_ = false;
+
+    std::mutex taskMutex_;
+    std::condition_variable taskAvailable_;
+    // Accounts with queued tasks
+    std::vector< std::shared_ptr<Account> > ready_;
+    bool stopWorkers_ = false;
+
+    void enqueue(const std::shared_ptr<Account> &account,
+                 std::vector< std::function<void()> > &tasks)
+    {
+        {
+            std::lock_guard<std::mutex> lock(taskMutex_);
+            if(account->tasks.empty())
+            {
+                // An idle job doesn't bank time it didn't ask for
+                bool found = false;
+                double least = 0;
+                for(const auto &other : ready_)
+                {
+                    if(other->priority != account->priority) continue;
+                    if(!found || other->virtualTime < least)
+                    {
+                        least = other->virtualTime;
+                        found = true;
+                    }
+                }
+                if(found)
+                {
+                    account->virtualTime = std::max(account->virtualTime,
+                                                     least);
+                }
+                ready_.push_back(account);
+            }
+            for(auto &task : tasks) account->tasks.push_back(std::move(task));
+        }
+        taskAvailable_.notify_all();
+    }
+
+    void work()
+    {
+        std::unique_lock<std::mutex> lock(taskMutex_);
+        while(true)
+        {
+            taskAvailable_.wait(lock, [this]() {
+                return stopWorkers_ || !ready_.empty();
+            });
+            if(ready_.empty()) return;
+            size_t chosen = 0;
+            for(size_t i = 1; i < ready_.size(); ++i)
+            {
+                const Account &candidate = *ready_[i];
+                const Account &best = *ready_[chosen];
+                if(candidate.priority > best.priority ||
+                   (candidate.priority == best.priority &&
+                    candidate.virtualTime < best.virtualTime))
+                {
+                    chosen = i;
+                }
+            }
+            const std::shared_ptr<Account> account = ready_[chosen];
+            std::function<void()> task = std::move(account->tasks.front());
+            account->tasks.pop_front();
+            if(account->tasks.empty())
+            {
+                ready_[chosen] = std::move(ready_.back());
+                ready_.pop_back();
+            }
+            lock.unlock();
+            const auto start = std::chrono::steady_clock::now();
+            task();
+            const std::chrono::duration<double> elapsed =
+                    std::chrono::steady_clock::now() - start;
+            lock.lock();
+            account->virtualTime += elapsed.count() / account->share;
+        }
+    }
+
+    void drive()
+    {
+        while(true)
+        {
+            PendingJob job;
+            {
+                std::unique_lock<std::mutex> lock(jobMutex_);
+                jobAvailable_.wait(lock, [this]() {
+                    return stopJobs_ || !pending_.empty();
+                });
+                if(pending_.empty()) return;
+                job = pending_.top();
+                pending_.pop();
+            }
+            auto account = std::make_shared<Account>();
+            account->priority = job.priority;
+            account->share = job.share;
+            job.run(std::make_shared<JobExecutor>(*this, account));
+        }
+    }
+};
+
+}
+
+#endif // SCHEDULER_H
@@ -11,7 +11,8 @@ template<typename GenType>
 class Selection
 {
 public:
-    virtual std::vector< Organism<GenType> >
+    // Returns indices of the selected parents in the population
+    virtual std::vector<size_t>
     selection(const std::vector< Organism<GenType> > &) = 0;
     virtual ~Selection() = default;
 };
@@ -20,10 +21,10 @@ public:
 template<typename GenType>
 class RouletteSelection : public Selection<GenType>
 {
-    std::vector< Organism<GenType> >
+    std::vector<size_t>
     selection(const std::vector< Organism<GenType> > &population) override
     {
-        std::vector< Organism<GenType> > parentPool;
+        std::vector<size_t> parentPool;
         std::vector<double> sums(population.size());
         sums[0] = population[1].fitness;
         for(size_t i = 1; i < population.size(); ++i)
@@ -36,7 +37,7 @@ class RouletteSelection : public Selection<GenType>
                     static_cast<double>(RAND_MAX / sums.back());
             auto org = std::lower_bound(sums.begin(), sums.end(),
                      val);
-            parentPool.push_back(population[org - sums.begin()]);
+            parentPool.push_back(org - sums.begin());
         }
 
         return parentPool;
@@ -48,10 +49,10 @@ class TournamentSelection : public Selection<GenType>
 {
 public:
     TournamentSelection(size_t size) : size_(size) {}
-    std::vector< Organism<GenType> >
+    std::vector<size_t>
     selection(const std::vector< Organism<GenType> > &population) override
     {
-        std::vector< Organism<GenType> > parentPool;
+        std::vector<size_t> parentPool;
         for(size_t i = 0; i < population.size(); ++i)
         {
             size_t winner = population.size() - 1;
@@ -61,7 +62,7 @@ public:
                 if(tmp < winner) winner = tmp;
             }
 
-            parentPool.push_back(population[winner]);
+            parentPool.push_back(winner);
         }
 
         return parentPool;
@@ -0,0 +1,854 @@
+#ifndef SERVICE_H
+#define SERVICE_H
+
+#include <cerrno>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "geneticalgorithm.h"
+#include "scheduler.h"
+
+namespace ga
+{
+
+// Binary protocol of the optimization service. Every frame is a 4 byte
+// payload length, a 1 byte message type and the payload. Values are
+// packed in the host's byte order since both ends share a machine.
+namespace protocol
+{
+
+enum MessageType : uint8_t
+{
+    Optimize = 1,   // client -> server, OptimizationRequest
+    Cancel = 2,     // client -> server, request id
+    Progress = 3,   // server -> client, OptimizationProgress
+    Result = 4      // server -> client, OptimizationResult
+};
+
+const uint32_t maxFrameSize = 64 << 20;
+
+class MessageWriter
+{
+public:
+    template<typename T>
+    void put(T value)
+    {
+        const char *bytes = reinterpret_cast<const char *>(&value);
+        data_.insert(data_.end(), bytes, bytes + sizeof(value));
+    }
+    void putString(const std::string &value)
+    {
+        put<uint32_t>(value.size());
+        data_.insert(data_.end(), value.begin(), value.end());
+    }
+    void putDoubles(const std::vector<double> &values)
+    {
+        put<uint32_t>(values.size());
+        const char *bytes = reinterpret_cast<const char *>(values.data());
+        data_.insert(data_.end(), bytes,
+                     bytes + values.size() * sizeof(double));
+    }
+    const std::vector<char> &data() const
+    {
+        return data_;
+    }
+
+private:
+    std::vector<char> data_;
+};
+
+// Reads fail softly: after the first overrun ok() is false and every
+// further value is zero
+class MessageReader
+{
+public:
+    MessageReader(const std::vector<char> &data) : data_(data) {}
+
+    template<typename T>
+    T get()
+    {
+        T value = T();
+        if(take(sizeof(value))) std::memcpy(&value, data_.data() +
+                                            position_ - sizeof(value),
+                                            sizeof(value));
+        return value;
+    }
+    std::string getString()
+    {
+        const uint32_t size = get<uint32_t>();
+        if(!take(size)) return std::string();
+        return std::string(data_.data() + position_ - size, size);
+    }
+    std::vector<double> getDoubles()
+    {
+        const uint32_t size = get<uint32_t>();
+        std::vector<double> values;
+        if(size > data_.size() / sizeof(double) ||
+           !take(size * sizeof(double)))
+        {
+            ok_ = false;
+            return values;
+        }
+        if(!size) return values;
+        values.resize(size);
+        std::memcpy(values.data(),
+                    data_.data() + position_ - size * sizeof(double),
+                    size * sizeof(double));
+        return values;
+    }
+    bool ok() const
+    {
+        return ok_;
+    }
+
+private:
+    const std::vector<char> &data_;
+    size_t position_ = 0;
+    bool ok_ = true;
+
+    bool take(size_t size)
+    {
+        if(!ok_ || size > data_.size() - position_)
+        {
+            ok_ = false;
+            return false;
+        }
+        position_ += size;
+        return true;
+    }
+};
+
+inline bool sendAll(int descriptor, const char *data, size_t size)
+{
+    while(size)
+    {
+        const ssize_t sent = ::send(descriptor, data, size, MSG_NOSIGNAL);
+        if(sent <= 0) return false;
+        data += sent;
+        size -= sent;
+    }
+    return true;
+}
+
+inline bool receiveAll(int descriptor, char *data, size_t size)
+{
+    while(size)
+    {
+        const ssize_t received = ::recv(descriptor, data, size, 0);
+        if(received <= 0) return false;
+        data += received;
+        size -= received;
+    }
+    return true;
+}
+
+inline bool writeFrame(int descriptor, uint8_t type,
+                       const MessageWriter &message)
+{
+    std::vector<char> frame(5);
+    const uint32_t size = message.data().size();
+    std::memcpy(frame.data(), &size, sizeof(size));
+    frame[4] = static_cast<char>(type);
+    frame.insert(frame.end(), message.data().begin(), message.data().end());
+    return sendAll(descriptor, frame.data(), frame.size());
+}
+
+inline bool readFrame(int descriptor, uint8_t &type,
+                      std::vector<char> &payload)
+{
+    char header[5];
+    if(!receiveAll(descriptor, header, sizeof(header))) return false;
+    uint32_t size;
+    std::memcpy(&size, header, sizeof(size));
+    if(size > maxFrameSize) return false;
+    type = static_cast<uint8_t>(header[4]);
+    payload.resize(size);
+    return receiveAll(descriptor, payload.data(), size);
+}
+
+}
+
+enum class SelectionKind : uint8_t
+{
+    Tournament,
+    Roulette
+};
+
+enum class CrossoverKind : uint8_t
+{
+    Intermediate,
+    Linear,
+    Discrete,
+    SinglePoint,
+    MultiPoint
+};
+
+enum class MutationKind : uint8_t
+{
+    None,
+    Gaussian
+};
+
+// Real valued problem of the registry; the dimensions are the bound sizes
+struct OptimizationRequest
+{
+    uint32_t id = 0;
+    std::string problem;
+    std::vector<double> lower;
+    std::vector<double> upper;
+    bool minimize = true;
+    uint32_t populationSize = 50;
+    // Budget, maxEvaluations = 0 disables the evaluation cap
+    uint64_t maxGenerations = 1000;
+    uint64_t maxEvaluations = 0;
+    bool hasTarget = false;
+    double target = 0;
+    SelectionKind selection = SelectionKind::Tournament;
+    uint32_t tournamentSize = 4;
+    CrossoverKind crossover = CrossoverKind::Intermediate;
+    // Deviation of the blending factor or number of cut points
+    double crossoverParameter = 0.5;
+    MutationKind mutation = MutationKind::Gaussian;
+    double mutationDeviation = 1;
+    // Percent of offspring which are mutated
+    double mutationProbability = 10;
+    uint32_t elites = 2;
+    // Generations between progress reports, 0 disables them
+    uint32_t progressPeriod = 0;
+    int32_t priority = 0;
+
+    void write(protocol::MessageWriter &message) const
+    {
+        message.put(id);
+        message.putString(problem);
+        message.putDoubles(lower);
+        message.putDoubles(upper);
+        message.put<uint8_t>(minimize);
+        message.put(populationSize);
+        message.put(maxGenerations);
+        message.put(maxEvaluations);
+        message.put<uint8_t>(hasTarget);
+        message.put(target);
+        message.put(selection);
+        message.put(tournamentSize);
+        message.put(crossover);
+        message.put(crossoverParameter);
+        message.put(mutation);
+        message.put(mutationDeviation);
+        message.put(mutationProbability);
+        message.put(elites);
+        message.put(progressPeriod);
+        message.put(priority);
+    }
+
+    bool read(protocol::MessageReader &message)
+    {
+        id = message.get<uint32_t>();
+        problem = message.getString();
+        lower = message.getDoubles();
+        upper = message.getDoubles();
+        minimize = message.get<uint8_t>();
+        populationSize = message.get<uint32_t>();
+        maxGenerations = message.get<uint64_t>();
+        maxEvaluations = message.get<uint64_t>();
+        hasTarget = message.get<uint8_t>();
+        target = message.get<double>();
+        selection = message.get<SelectionKind>();
+        tournamentSize = message.get<uint32_t>();
+        crossover = message.get<CrossoverKind>();
+        crossoverParameter = message.get<double>();
+        mutation = message.get<MutationKind>();
+        mutationDeviation = message.get<double>();
+        mutationProbability = message.get<double>();
+        elites = message.get<uint32_t>();
+        progressPeriod = message.get<uint32_t>();
+        priority = message.get<int32_t>();
+        return message.ok();
+    }
+
+    bool valid() const
+    {
+        for(size_t i = 0; i < lower.size() && i < upper.size(); ++i)
+        {
+            if(!(lower[i] <= upper[i]) || !std::isfinite(lower[i]) ||
+               !std::isfinite(upper[i]))
+            {
+                return false;
+            }
+        }
+        if(lower.empty() || lower.size() != upper.size() ||
+           populationSize < 2 || populationSize > maxPopulationSize ||
+           static_cast<uint64_t>(populationSize) * lower.size() > maxGenes ||
+           maxGenerations == 0 || tournamentSize == 0 ||
+           tournamentSize > populationSize ||
+           elites >= populationSize ||
+           selection > SelectionKind::Roulette ||
+           crossover > CrossoverKind::MultiPoint ||
+           mutation > MutationKind::Gaussian)
+        {
+            return false;
+        }
+        if(!(mutationProbability >= 0 && mutationProbability <= 100) ||
+           (hasTarget && !std::isfinite(target)))
+        {
+            return false;
+        }
+        // Normal distributions need a positive finite deviation
+        auto deviation = [](double value) {
+            return value > 0 && std::isfinite(value);
+        };
+        if(mutation == MutationKind::Gaussian &&
+           !deviation(mutationDeviation))
+        {
+            return false;
+        }
+        switch(crossover)
+        {
+        case CrossoverKind::Intermediate:
+        case CrossoverKind::Linear:
+            return deviation(crossoverParameter);
+        case CrossoverKind::MultiPoint:
+            // Cut points are distinct genes
+            return crossoverParameter >= 0 &&
+                    crossoverParameter <= lower.size();
+        default:
+            return true;
+        }
+    }
+
+    // Limits keeping a single request from exhausting the daemon's memory
+    static constexpr uint32_t maxPopulationSize = 1 << 20;
+    static constexpr uint64_t maxGenes = uint64_t(1) << 26;
+};
+
+struct OptimizationProgress
+{
+    uint32_t id = 0;
+    uint64_t generation = 0;
+    uint64_t evaluations = 0;
+    double best = 0;
+    double mean = 0;
+    double diversity = 0;
+
+    void write(protocol::MessageWriter &message) const
+    {
+        message.put(id);
+        message.put(generation);
+        message.put(evaluations);
+        message.put(best);
+        message.put(mean);
+        message.put(diversity);
+    }
+
+    bool read(protocol::MessageReader &message)
+    {
+        id = message.get<uint32_t>();
+        generation = message.get<uint64_t>();
+        evaluations = message.get<uint64_t>();
+        best = message.get<double>();
+        mean = message.get<double>();
+        diversity = message.get<double>();
+        return message.ok();
+    }
+};
+
+enum class OptimizationStatus : uint8_t
+{
+    Finished,
+    Cancelled,
+    UnknownProblem,
+    InvalidRequest,
+    // The optimization threw, e.g. from the problem function
+    Failed
+};
+
+struct OptimizationResult
+{
+    uint32_t id = 0;
+    OptimizationStatus status = OptimizationStatus::Finished;
+    uint64_t generations = 0;
+    uint64_t evaluations = 0;
+    double fitness = 0;
+    std::vector<double> chromosome;
+
+    void write(protocol::MessageWriter &message) const
+    {
+        message.put(id);
+        message.put(status);
+        message.put(generations);
+        message.put(evaluations);
+        message.put(fitness);
+        message.putDoubles(chromosome);
+    }
+
+    bool read(protocol::MessageReader &message)
+    {
+        id = message.get<uint32_t>();
+        status = message.get<OptimizationStatus>();
+        generations = message.get<uint64_t>();
+        evaluations = message.get<uint64_t>();
+        fitness = message.get<double>();
+        chromosome = message.getDoubles();
+        return message.ok();
+    }
+};
+
+// Named fitness functions which requests may refer to. Functions are
+// called concurrently from the worker pool.
+class ProblemRegistry
+{
+public:
+    using Problem = std::function<double(const std::vector<double> &)>;
+
+    void add(const std::string &name, Problem problem)
+    {
+        problems_[name] = std::move(problem);
+    }
+
+    const Problem *find(const std::string &name) const
+    {
+        const auto found = problems_.find(name);
+        return (found != problems_.end()) ? &found->second : nullptr;
+    }
+
+private:
+    std::map<std::string, Problem> problems_;
+};
+
+// Serves optimization requests on a Unix domain socket. Every request
+// becomes a job of the shared scheduler; a connection may have several
+// requests in flight and gets their progress reports and results tagged
+// with the request id. Closing a connection cancels its requests.
+class OptimizationServer
+{
+public:
+    OptimizationServer(const ProblemRegistry &registry,
+                       Scheduler &scheduler) :
+        registry_(registry), scheduler_(scheduler) {}
+    OptimizationServer(const OptimizationServer &) = delete;
+    OptimizationServer &operator=(const OptimizationServer &) = delete;
+    ~OptimizationServer()
+    {
+        stop();
+        if(listener_ >= 0) ::close(listener_);
+    }
+
+    // Replaces a stale socket file at path
+    bool listen(const std::string &path)
+    {
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if(path.size() >= sizeof(address.sun_path)) return false;
+        std::strcpy(address.sun_path, path.c_str());
+        listener_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if(listener_ < 0) return false;
+        ::unlink(path.c_str());
+        if(::bind(listener_, reinterpret_cast<sockaddr *>(&address),
+                  sizeof(address)) || ::listen(listener_, 64))
+        {
+            ::close(listener_);
+            listener_ = -1;
+            return false;
+        }
+        path_ = path;
+        return true;
+    }
+
+    // Accepts connections until stop()
+    void run()
+    {
+        while(true)
+        {
+            const int descriptor = ::accept(listener_, nullptr, nullptr);
+            if(descriptor < 0)
+            {
+                if(stopping_) break;
+                if(errno == EINTR) continue;
+                break;
+            }
+            auto connection = std::make_shared<Connection>(descriptor);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if(stopping_)
+                {
+                    ::shutdown(descriptor, SHUT_RDWR);
+                    break;
+                }
+                connections_.insert(connection);
+            }
+            std::thread(&OptimizationServer::serve, this, connection)
+                    .detach();
+        }
+    }
+
+    // Safe to call from any thread or a signal handling thread; waits for
+    // the connection readers, requests finish on the scheduler
+    void stop()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if(!stopping_)
+        {
+            stopping_ = true;
+            if(listener_ >= 0) ::shutdown(listener_, SHUT_RDWR);
+            if(!path_.empty()) ::unlink(path_.c_str());
+            for(const auto &connection : connections_)
+            {
+                ::shutdown(connection->descriptor, SHUT_RDWR);
+            }
+        }
+        closed_.wait(lock, [this]() { return connections_.empty(); });
+    }
+
+private:
+    struct Connection
+    {
+        Connection(int fd) : descriptor(fd) {}
+        ~Connection() { ::close(descriptor); }
+
+        bool send(uint8_t type, const protocol::MessageWriter &message)
+        {
+            std::lock_guard<std::mutex> lock(writeMutex);
+            return protocol::writeFrame(descriptor, type, message);
+        }
+
+        const int descriptor;
+        std::mutex writeMutex;
+        std::mutex jobsMutex;
+        std::map<uint32_t, CancellationToken> jobs;
+    };
+
+    // Streams statistics every period generations
+    class ProgressDisplay : public Display<double>
+    {
+    public:
+        ProgressDisplay(std::shared_ptr<Connection> connection, uint32_t id,
+                        uint32_t period) :
+            connection_(std::move(connection)), period_(period)
+        {
+            progress_.id = id;
+        }
+        void update(const Statistics &statistics) override
+        {
+            progress_.generation = statistics.generation;
+            progress_.evaluations = statistics.evaluations;
+            progress_.best = statistics.best;
+            progress_.mean = statistics.mean;
+            progress_.diversity = statistics.diversity;
+        }
+        void display(const Population<double> &, unsigned long iter) override
+        {
+            if(iter % period_) return;
+            protocol::MessageWriter message;
+            progress_.write(message);
+            connection_->send(protocol::Progress, message);
+        }
+
+    private:
+        std::shared_ptr<Connection> connection_;
+        const uint32_t period_;
+        OptimizationProgress progress_;
+    };
+
+    const ProblemRegistry &registry_;
+    Scheduler &scheduler_;
+    int listener_ = -1;
+    std::string path_;
+    std::mutex mutex_;
+    std::condition_variable closed_;
+    std::set< std::shared_ptr<Connection> > connections_;
+    bool stopping_ = false;
+
+    void serve(std::shared_ptr<Connection> connection)
+    {
+        uint8_t type;
+        std::vector<char> payload;
+        while(protocol::readFrame(connection->descriptor, type, payload))
+        {
+            protocol::MessageReader message(payload);
+            if(type == protocol::Optimize)
+            {
+                OptimizationRequest request;
+                const bool parsed = request.read(message);
+                submit(connection, request, parsed);
+            }
+            else if(type == protocol::Cancel)
+            {
+                const uint32_t id = message.get<uint32_t>();
+                std::lock_guard<std::mutex> lock(connection->jobsMutex);
+                const auto found = connection->jobs.find(id);
+                if(found != connection->jobs.end()) found->second.cancel();
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(connection->jobsMutex);
+            for(auto &job : connection->jobs) job.second.cancel();
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        connections_.erase(connection);
+        closed_.notify_all();
+    }
+
+    void submit(const std::shared_ptr<Connection> &connection,
+                const OptimizationRequest &request, bool parsed)
+    {
+        OptimizationResult result;
+        result.id = request.id;
+        const ProblemRegistry::Problem *problem =
+                registry_.find(request.problem);
+        CancellationToken token;
+        bool accepted = false;
+        if(!parsed || !request.valid())
+        {
+            result.status = OptimizationStatus::InvalidRequest;
+        }
+        else if(!problem)
+        {
+            result.status = OptimizationStatus::UnknownProblem;
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(connection->jobsMutex);
+            // A running job keeps its id, else it couldn't be cancelled
+            accepted = connection->jobs.emplace(request.id, token).second;
+            if(!accepted) result.status = OptimizationStatus::InvalidRequest;
+        }
+        if(!accepted)
+        {
+            protocol::MessageWriter message;
+            result.write(message);
+            connection->send(protocol::Result, message);
+            return;
+        }
+        const ProblemRegistry::Problem function = *problem;
+        scheduler_.submit([connection, request, token, function](
+                          const std::shared_ptr<Executor> &executor) {
+            OptimizationResult result;
+            try
+            {
+                result = optimize(request, function, token, connection,
+                                  executor);
+            }
+            catch(...)
+            {
+                // The client waits for a result whatever happens
+                result = OptimizationResult();
+                result.id = request.id;
+                result.status = OptimizationStatus::Failed;
+            }
+            {
+                std::lock_guard<std::mutex> lock(connection->jobsMutex);
+                connection->jobs.erase(request.id);
+            }
+            protocol::MessageWriter message;
+            result.write(message);
+            connection->send(protocol::Result, message);
+        }, request.priority);
+    }
+
+    static OptimizationResult optimize(
+            const OptimizationRequest &request,
+            const ProblemRegistry::Problem &problem,
+            const CancellationToken &token,
+            const std::shared_ptr<Connection> &connection,
+            const std::shared_ptr<Executor> &executor)
+    {
+        const size_t dimensions = request.lower.size();
+        GeneticAlgorithm<double> ga(dimensions, request.populationSize);
+        ga.setInitializationAlgorithm(
+                    std::make_unique< UniformInitialization<double> >(
+                        std::vector<double>(request.lower),
+                        std::vector<double>(request.upper)));
+        ga.setLinearBounds(std::vector<double>(request.lower),
+                           std::vector<double>(request.upper));
+        if(request.elites)
+        {
+            ga.setPrepopulationAlgorithm(
+                        std::make_unique< EliteStrategy<double> >(
+                            request.elites));
+        }
+        if(request.selection == SelectionKind::Roulette)
+        {
+            ga.setSelectionAlgorithm(
+                        std::make_unique< RouletteSelection<double> >());
+        }
+        else
+        {
+            ga.setSelectionAlgorithm(
+                        std::make_unique< TournamentSelection<double> >(
+                            request.tournamentSize));
+        }
+        ga.setCrossoverAlgorithm(crossover(request));
+        if(request.mutation == MutationKind::Gaussian)
+        {
+            ga.setMutationAlgorithm(
+                        std::make_unique< GaussianMutation<double> >(
+                            request.mutationDeviation));
+        }
+
+        auto stopping = std::make_unique< AnyCriteria<double> >();
+        stopping->add(std::make_unique< IterationCriteria<double> >(
+                          request.maxGenerations));
+        stopping->add(std::make_unique< CancellationCriteria<double> >(
+                          token));
+        if(request.maxEvaluations)
+        {
+            stopping->add(std::make_unique< EvaluationCriteria<double> >(
+                              request.maxEvaluations));
+        }
+        if(request.hasTarget)
+        {
+            stopping->add(std::make_unique< FitnessCriteria<double> >(
+                              request.target, request.minimize, 0));
+        }
+        ga.setStoppingCriteria(std::move(stopping));
+        ga.setFitnessFunction([&problem](Organism<double> &org) {
+            org.fitness = problem(org.chromosome);
+        });
+        if(request.progressPeriod)
+        {
+            ga.setDisplayFunction(std::make_unique<ProgressDisplay>(
+                                      connection, request.id,
+                                      request.progressPeriod));
+        }
+        ga.setExecutor(executor);
+
+        const Organism<double> best = ga.optimize(request.mutationProbability,
+                                                  request.minimize);
+        OptimizationResult result;
+        result.id = request.id;
+        result.status = (token.cancelled()) ? OptimizationStatus::Cancelled :
+                                              OptimizationStatus::Finished;
+        result.generations = ga.statistics().generation;
+        result.evaluations = ga.statistics().evaluations;
+        result.fitness = best.fitness;
+        result.chromosome = best.chromosome;
+        return result;
+    }
+
+    static CrossoverPtr<double> crossover(const OptimizationRequest &request)
+    {
+        switch(request.crossover)
+        {
+        case CrossoverKind::Linear:
+            return std::make_unique< LinearCrossover<double> >(
+                        request.crossoverParameter);
+        case CrossoverKind::Discrete:
+            return std::make_unique< DiscreteCrossover<double> >();
+        case CrossoverKind::SinglePoint:
+            return std::make_unique< SinglePointCrossover<double> >();
+        case CrossoverKind::MultiPoint:
+            return std::make_unique< MultiPointCrossover<double> >(
+                        static_cast<size_t>(
+                            std::max(1.0, request.crossoverParameter)));
+        default:
+            return std::make_unique< IntermediateCrossover<double> >(
+                        request.crossoverParameter);
+        }
+    }
+};
+
+// Blocking client of the optimization service
+class OptimizationClient
+{
+public:
+    OptimizationClient() = default;
+    OptimizationClient(const OptimizationClient &) = delete;
+    OptimizationClient &operator=(const OptimizationClient &) = delete;
+    ~OptimizationClient()
+    {
+        close();
+    }
+
+    bool connect(const std::string &path)
+    {
+        close();
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if(path.size() >= sizeof(address.sun_path)) return false;
+        std::strcpy(address.sun_path, path.c_str());
+        descriptor_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if(descriptor_ < 0) return false;
+        if(::connect(descriptor_, reinterpret_cast<sockaddr *>(&address),
+                     sizeof(address)))
+        {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close()
+    {
+        if(descriptor_ >= 0) ::close(descriptor_);
+        descriptor_ = -1;
+    }
+
+    // Sends the request and waits for its result, passing the progress
+    // reports to the callback. Returns false if the connection failed.
+    bool optimize(const OptimizationRequest &request,
+                  OptimizationResult &result,
+                  std::function<void(const OptimizationProgress &)>
+                  progress = nullptr)
+    {
+        protocol::MessageWriter message;
+        request.write(message);
+        if(!send(protocol::Optimize, message)) return false;
+        uint8_t type;
+        std::vector<char> payload;
+        while(protocol::readFrame(descriptor_, type, payload))
+        {
+            protocol::MessageReader reader(payload);
+            if(type == protocol::Progress)
+            {
+                OptimizationProgress report;
+                if(report.read(reader) && report.id == request.id &&
+                   progress)
+                {
+                    progress(report);
+                }
+            }
+            else if(type == protocol::Result)
+            {
+                if(result.read(reader) && result.id == request.id)
+                {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // May be called from another thread while optimize() waits
+    bool cancel(uint32_t id)
+    {
+        protocol::MessageWriter message;
+        message.put(id);
+        return send(protocol::Cancel, message);
+    }
+
+private:
+    int descriptor_ = -1;
+    std::mutex writeMutex_;
+
+    bool send(uint8_t type, const protocol::MessageWriter &message)
+    {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        return protocol::writeFrame(descriptor_, type, message);
+    }
+};
+
+}
+
+#endif // SERVICE_H
@@ -0,0 +1,466 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "organism.h"
+#include "display.h"
+#include "geneticalgorithm.h"
+
+namespace ga
+{
+
+// Columnar population snapshots. The file is a 64 byte header followed by
+// one block per written generation and, once the writer is closed, an
+// index of the blocks and a trailer:
+//
+//   header   magic "GASNAP01", byte order mark, gene kind, gene bytes,
+//            chromosome size
+//   block    magic "GBLK", generation, count, count x chromosome size
+//            gene matrix (row per organism), count fitness values
+//   index    (generation, offset, count) per block
+//   trailer  number of blocks, index offset, magic "GAIDX001"
+//
+// Every section starts at a multiple of 8 bytes and values are stored in
+// the writer's byte order, so a mapped file can be read in place. Files
+// without a trailer (interrupted runs) are indexed by scanning the blocks.
+namespace snapshot
+{
+
+const char headerMagic[8] = {'G', 'A', 'S', 'N', 'A', 'P', '0', '1'};
+const char indexMagic[8] = {'G', 'A', 'I', 'D', 'X', '0', '0', '1'};
+const uint32_t blockMagic = 0x4b4c4247; // "GBLK"
+const uint32_t byteOrderMark = 0x01020304;
+
+enum GeneKind : uint32_t
+{
+    Unsigned = 0,
+    Signed = 1,
+    Floating = 2,
+    Binary = 3
+};
+
+struct Header
+{
+    char magic[8];
+    uint32_t byteOrder;
+    uint32_t kind;
+    uint32_t geneBytes;
+    uint32_t reserved;
+    uint64_t chromosomeSize;
+    uint64_t padding[4];
+};
+
+struct BlockHeader
+{
+    uint32_t magic;
+    uint32_t reserved;
+    uint64_t generation;
+    uint64_t count;
+};
+
+struct IndexEntry
+{
+    uint64_t generation;
+    uint64_t offset;
+    uint64_t count;
+};
+
+struct Trailer
+{
+    uint64_t entries;
+    uint64_t indexOffset;
+    char magic[8];
+};
+
+static_assert(sizeof(Header) == 64, "Unexpected snapshot header layout");
+static_assert(sizeof(BlockHeader) == 24, "Unexpected block header layout");
+
+inline uint64_t aligned(uint64_t bytes)
+{
+    return (bytes + 7) & ~uint64_t(7);
+}
+
+// Stored representation of a gene type, binary genes take a byte each
+template<typename GenType>
+struct Gene
+{
+    using type = GenType;
+    static constexpr uint32_t kind =
+            std::is_floating_point<GenType>::value ? Floating :
+            std::is_signed<GenType>::value ? Signed : Unsigned;
+};
+
+template<>
+struct Gene<bool>
+{
+    using type = uint8_t;
+    static constexpr uint32_t kind = Binary;
+};
+
+}
+
+// Appends generations to a snapshot file through a large stdio buffer.
+// Chromosomes are written straight from their vectors.
+template<typename GenType>
+class SnapshotWriter
+{
+    using Stored = typename snapshot::Gene<GenType>::type;
+
+public:
+    SnapshotWriter(const std::string &path, size_t bufferSize = 1 << 20) :
+        file_(std::fopen(path.c_str(), "wb")), buffer_(bufferSize)
+    {
+        if(file_ && !buffer_.empty())
+        {
+            std::setvbuf(file_, buffer_.data(), _IOFBF, buffer_.size());
+        }
+    }
+    SnapshotWriter(const SnapshotWriter &) = delete;
+    SnapshotWriter &operator=(const SnapshotWriter &) = delete;
+    ~SnapshotWriter()
+    {
+        close();
+    }
+
+    bool good() const
+    {
+        return file_ && !failed_;
+    }
+
+    void write(const Population<GenType> &population,
+               unsigned long generation)
+    {
+        if(!good() || population.empty()) return;
+        const uint64_t chromosomeSize = population.front().chromosome.size();
+        for(const auto &org : population)
+        {
+            // Refuse the block before writing any of it
+            if(org.chromosome.size() != chromosomeSize)
+            {
+                failed_ = true;
+                return;
+            }
+        }
+        if(!offset_) writeHeader(chromosomeSize);
+
+        snapshot::BlockHeader block = {snapshot::blockMagic, 0, generation,
+                                       population.size()};
+        index_.push_back({generation, offset_, population.size()});
+        put(&block, sizeof(block));
+        for(const auto &org : population)
+        {
+            putChromosome(org.chromosome, chromosomeSize);
+        }
+        pad();
+        fitness_.resize(population.size());
+        for(size_t i = 0; i < population.size(); ++i)
+        {
+            fitness_[i] = population[i].fitness;
+        }
+        put(fitness_.data(), fitness_.size() * sizeof(double));
+    }
+
+    // Writes the index; further writes are ignored
+    void close()
+    {
+        if(!file_) return;
+        if(offset_)
+        {
+            snapshot::Trailer trailer;
+            trailer.entries = index_.size();
+            trailer.indexOffset = offset_;
+            std::memcpy(trailer.magic, snapshot::indexMagic,
+                        sizeof(trailer.magic));
+            put(index_.data(), index_.size() * sizeof(snapshot::IndexEntry));
+            put(&trailer, sizeof(trailer));
+        }
+        if(std::fclose(file_)) failed_ = true;
+        file_ = nullptr;
+    }
+
+private:
+    std::FILE *file_;
+    std::vector<char> buffer_;
+    uint64_t offset_ = 0;
+    bool failed_ = false;
+    std::vector<snapshot::IndexEntry> index_;
+    std::vector<double> fitness_;
+    std::vector<uint8_t> bytes_;
+
+    void put(const void *data, size_t size)
+    {
+        if(size && std::fwrite(data, 1, size, file_) != size) failed_ = true;
+        offset_ += size;
+    }
+
+    void pad()
+    {
+        static const char zeros[8] = {};
+        put(zeros, snapshot::aligned(offset_) - offset_);
+    }
+
+    void writeHeader(uint64_t chromosomeSize)
+    {
+        snapshot::Header header = {};
+        std::memcpy(header.magic, snapshot::headerMagic,
+                    sizeof(header.magic));
+        header.byteOrder = snapshot::byteOrderMark;
+        header.kind = snapshot::Gene<GenType>::kind;
+        header.geneBytes = sizeof(Stored);
+        header.chromosomeSize = chromosomeSize;
+        put(&header, sizeof(header));
+    }
+
+    template<typename T>
+    void putChromosome(const std::vector<T> &chromosome, uint64_t size)
+    {
+        if(chromosome.size() != size)
+        {
+            failed_ = true;
+            return;
+        }
+        put(chromosome.data(), size * sizeof(T));
+    }
+
+    void putChromosome(const std::vector<bool> &chromosome, uint64_t size)
+    {
+        if(chromosome.size() != size)
+        {
+            failed_ = true;
+            return;
+        }
+        bytes_.resize(size);
+        for(size_t i = 0; i < size; ++i) bytes_[i] = chromosome[i];
+        put(bytes_.data(), size);
+    }
+};
+
+// Writes every period-th generation into a snapshot file
+template<typename GenType>
+class SnapshotDisplay : public Display<GenType>
+{
+public:
+    SnapshotDisplay(const std::string &path, unsigned long period = 1) :
+        writer_(path), period_(period) {}
+    void display(const Population<GenType> &population,
+                 unsigned long iter) override
+    {
+        if(period_ && iter % period_ == 0) writer_.write(population, iter);
+    }
+
+private:
+    SnapshotWriter<GenType> writer_;
+    const unsigned long period_;
+};
+
+// One generation of a mapped snapshot. Pointers refer to the mapping and
+// stay valid while the reader is open.
+template<typename GenType>
+class GenerationView
+{
+public:
+    using value_type = typename snapshot::Gene<GenType>::type;
+
+    GenerationView() = default;
+    GenerationView(unsigned long generation, size_t size,
+                   size_t chromosomeSize, const value_type *genes,
+                   const double *fitness) :
+        generation_(generation), size_(size),
+        chromosomeSize_(chromosomeSize), genes_(genes), fitness_(fitness) {}
+
+    unsigned long generation() const { return generation_; }
+    size_t size() const { return size_; }
+    size_t chromosomeSize() const { return chromosomeSize_; }
+    bool empty() const { return !size_; }
+
+    // Row-major size() x chromosomeSize() gene matrix
+    const value_type *genes() const { return genes_; }
+    const value_type *chromosome(size_t i) const
+    {
+        return genes_ + i * chromosomeSize_;
+    }
+    const double *fitness() const { return fitness_; }
+    double fitness(size_t i) const { return fitness_[i]; }
+
+private:
+    unsigned long generation_ = 0;
+    size_t size_ = 0;
+    size_t chromosomeSize_ = 0;
+    const value_type *genes_ = nullptr;
+    const double *fitness_ = nullptr;
+};
+
+// Maps a snapshot file read-only
+class SnapshotReader
+{
+public:
+    SnapshotReader() = default;
+    SnapshotReader(const std::string &path)
+    {
+        open(path);
+    }
+    SnapshotReader(const SnapshotReader &) = delete;
+    SnapshotReader &operator=(const SnapshotReader &) = delete;
+    ~SnapshotReader()
+    {
+        close();
+    }
+
+    bool open(const std::string &path)
+    {
+        close();
+        const int descriptor = ::open(path.c_str(), O_RDONLY);
+        if(descriptor < 0) return false;
+        struct stat status;
+        if(fstat(descriptor, &status) == 0 &&
+           static_cast<size_t>(status.st_size) >= sizeof(snapshot::Header))
+        {
+            size_ = status.st_size;
+            void *data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE,
+                              descriptor, 0);
+            if(data != MAP_FAILED)
+            {
+                data_ = static_cast<const char *>(data);
+                madvise(data, size_, MADV_SEQUENTIAL);
+            }
+        }
+        ::close(descriptor);
+        if(!data_ || !readHeader())
+        {
+            close();
+            return false;
+        }
+        if(!readIndex()) scanBlocks();
+        return true;
+    }
+
+    void close()
+    {
+        if(data_) munmap(const_cast<char *>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+        index_.clear();
+    }
+
+    bool isOpen() const
+    {
+        return data_;
+    }
+
+    size_t generations() const
+    {
+        return index_.size();
+    }
+
+    size_t chromosomeSize() const
+    {
+        return header_.chromosomeSize;
+    }
+
+    // Whether the file stores genes of this type
+    template<typename GenType>
+    bool holds() const
+    {
+        return data_ && header_.kind == snapshot::Gene<GenType>::kind &&
+                header_.geneBytes ==
+                sizeof(typename snapshot::Gene<GenType>::type);
+    }
+
+    // Empty if the file stores another gene type
+    template<typename GenType>
+    GenerationView<GenType> generation(size_t i) const
+    {
+        using Stored = typename GenerationView<GenType>::value_type;
+        if(!holds<GenType>() || i >= index_.size()) return {};
+        const snapshot::IndexEntry &entry = index_[i];
+        const char *genes = data_ + entry.offset +
+                sizeof(snapshot::BlockHeader);
+        const char *fitness = genes + snapshot::aligned(
+                    entry.count * header_.chromosomeSize * sizeof(Stored));
+        return GenerationView<GenType>(
+                    entry.generation, entry.count, header_.chromosomeSize,
+                    reinterpret_cast<const Stored *>(genes),
+                    reinterpret_cast<const double *>(fitness));
+    }
+
+private:
+    const char *data_ = nullptr;
+    size_t size_ = 0;
+    snapshot::Header header_ = {};
+    std::vector<snapshot::IndexEntry> index_;
+
+    bool readHeader()
+    {
+        std::memcpy(&header_, data_, sizeof(header_));
+        return !std::memcmp(header_.magic, snapshot::headerMagic,
+                            sizeof(header_.magic)) &&
+                header_.byteOrder == snapshot::byteOrderMark &&
+                header_.geneBytes > 0;
+    }
+
+    uint64_t blockSize(uint64_t count) const
+    {
+        return sizeof(snapshot::BlockHeader) +
+                snapshot::aligned(count * header_.chromosomeSize *
+                                  header_.geneBytes) +
+                count * sizeof(double);
+    }
+
+    bool readIndex()
+    {
+        snapshot::Trailer trailer;
+        if(size_ < sizeof(snapshot::Header) + sizeof(trailer)) return false;
+        std::memcpy(&trailer, data_ + size_ - sizeof(trailer),
+                    sizeof(trailer));
+        if(std::memcmp(trailer.magic, snapshot::indexMagic,
+                       sizeof(trailer.magic)) ||
+           trailer.indexOffset > size_ - sizeof(trailer) ||
+           trailer.entries > (size_ - sizeof(trailer) -
+                              trailer.indexOffset) /
+           sizeof(snapshot::IndexEntry))
+        {
+            return false;
+        }
+        index_.resize(trailer.entries);
+        std::memcpy(index_.data(), data_ + trailer.indexOffset,
+                    index_.size() * sizeof(snapshot::IndexEntry));
+        for(const auto &entry : index_)
+        {
+            if(entry.offset + blockSize(entry.count) > trailer.indexOffset)
+            {
+                index_.clear();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Recovers the complete blocks of a file which was never closed
+    void scanBlocks()
+    {
+        uint64_t offset = sizeof(snapshot::Header);
+        snapshot::BlockHeader block;
+        while(offset + sizeof(block) <= size_)
+        {
+            std::memcpy(&block, data_ + offset, sizeof(block));
+            if(block.magic != snapshot::blockMagic) break;
+            const uint64_t size = blockSize(block.count);
+            if(offset + size > size_) break;
+            index_.push_back({block.generation, offset, block.count});
+            offset += size;
+        }
+    }
+};
+
+}
+
+#endif // SNAPSHOT_H
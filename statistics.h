@@ -0,0 +1,48 @@
+#ifndef STATISTICS_H
+#define STATISTICS_H
+
+#include "organism.h"
+
+namespace ga
+{
+
+// Collected once per generation right after the population is evaluated
+struct Statistics
+{
+    unsigned long generation = 0;
+    unsigned long evaluations = 0;
+    double best = 0;
+    double mean = 0;
+    double worst = 0;
+    double diversity = 0;
+    double entropy = 0;
+};
+
+template<typename GenType>
+void collectStatistics(const Population<GenType> &population, bool minimize,
+                       Statistics &statistics)
+{
+    if(population.empty()) return;
+    double best = population.front().fitness;
+    double worst = best;
+    double sum = 0;
+    for(const auto &org : population)
+    {
+        if(minimize ? org.fitness < best : org.fitness > best)
+        {
+            best = org.fitness;
+        }
+        if(minimize ? org.fitness > worst : org.fitness < worst)
+        {
+            worst = org.fitness;
+        }
+        sum += org.fitness;
+    }
+    statistics.best = best;
+    statistics.worst = worst;
+    statistics.mean = sum / population.size();
+}
+
+}
+
+#endif // STATISTICS_H
@@ -1,7 +1,12 @@
 #ifndef STOPPINGCRITERIA_H
 #define STOPPINGCRITERIA_H
 
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
 #include "organism.h"
+#include "statistics.h"
 #include "geneticalgorithm.h"
 
 namespace ga
@@ -11,6 +16,10 @@ template<typename GenType>
 class StoppingCriteria
 {
 public:
+    // Called once before the first generation
+    virtual void reset() {}
+    // Called once per generation before stop()
+    virtual void update(const Statistics &) {}
     virtual bool stop(unsigned long, const Population<GenType> &) = 0;
     virtual ~StoppingCriteria() = default;
 };
@@ -31,6 +40,7 @@ private:
     const unsigned long iterations_;
 };
 
+// maxIterations = 0 disables the iteration cap
 template<typename GenType>
 class FitnessCriteria : public StoppingCriteria<GenType>
 {
@@ -39,22 +49,238 @@ public:
                    unsigned long maxIterations = 10000) :
         desiredFitness_(desiredFitness),
         minimize_(minimize),
-        iterations_(maxIterations)
+        iterations_(maxIterations),
+        best_(0)
     {}
+    virtual void update(const Statistics &statistics) override
+    {
+        best_ = statistics.best;
+    }
     virtual bool stop(unsigned long iterations,
-                      const Population<GenType> &population) override
+                      const Population<GenType> &) override
     {
-        if(iterations >= iterations_) return true;
-        double best = population.front().fitness;
-        return (minimize_) ? best <= desiredFitness_ : best >= desiredFitness_;
+        if(iterations_ && iterations >= iterations_) return true;
+        return (minimize_) ? best_ <= desiredFitness_ :
+                             best_ >= desiredFitness_;
     }
 
 private:
     const double desiredFitness_;
     const bool minimize_;
     const unsigned long iterations_;
+    double best_;
+};
+
+// Stops when the best fitness hasn't improved by more than tolerance
+// during the given number of generations
+template<typename GenType>
+class StagnationCriteria : public StoppingCriteria<GenType>
+{
+public:
+    StagnationCriteria(unsigned long generations, bool minimize = true,
+                       double tolerance = 0) :
+        generations_(generations),
+        minimize_(minimize),
+        tolerance_(tolerance)
+    {
+        reset();
+    }
+    virtual void reset() override
+    {
+        stagnation_ = 0;
+        first_ = true;
+    }
+    virtual void update(const Statistics &statistics) override
+    {
+        const double improvement = (minimize_) ?
+                    best_ - statistics.best : statistics.best - best_;
+        if(first_ || improvement > tolerance_)
+        {
+            best_ = statistics.best;
+            stagnation_ = 0;
+            first_ = false;
+        }
+        else
+        {
+            ++stagnation_;
+        }
+    }
+    virtual bool stop(unsigned long, const Population<GenType> &) override
+    {
+        return stagnation_ >= generations_;
+    }
+
+private:
+    const unsigned long generations_;
+    const bool minimize_;
+    const double tolerance_;
+    unsigned long stagnation_;
+    double best_;
+    bool first_;
 };
 
+template<typename GenType>
+class DiversityCriteria : public StoppingCriteria<GenType>
+{
+public:
+    DiversityCriteria(double threshold) : threshold_(threshold), diversity_(0)
+    {}
+    virtual void update(const Statistics &statistics) override
+    {
+        diversity_ = statistics.diversity;
+    }
+    virtual bool stop(unsigned long, const Population<GenType> &) override
+    {
+        return diversity_ < threshold_;
+    }
+
+private:
+    const double threshold_;
+    double diversity_;
+};
+
+template<typename GenType>
+class TimeCriteria : public StoppingCriteria<GenType>
+{
+public:
+    TimeCriteria(std::chrono::milliseconds duration) : duration_(duration)
+    {
+        reset();
+    }
+    virtual void reset() override
+    {
+        deadline_ = std::chrono::steady_clock::now() + duration_;
+    }
+    virtual bool stop(unsigned long, const Population<GenType> &) override
+    {
+        return std::chrono::steady_clock::now() >= deadline_;
+    }
+
+private:
+    const std::chrono::milliseconds duration_;
+    std::chrono::steady_clock::time_point deadline_;
+};
+
+template<typename GenType>
+class EvaluationCriteria : public StoppingCriteria<GenType>
+{
+public:
+    EvaluationCriteria(unsigned long evaluations) :
+        maxEvaluations_(evaluations), evaluations_(0) {}
+    virtual void update(const Statistics &statistics) override
+    {
+        evaluations_ = statistics.evaluations;
+    }
+    virtual bool stop(unsigned long, const Population<GenType> &) override
+    {
+        return evaluations_ >= maxEvaluations_;
+    }
+
+private:
+    const unsigned long maxEvaluations_;
+    unsigned long evaluations_;
+};
+
+// Shared flag which can be raised from any thread
+class CancellationToken
+{
+public:
+    CancellationToken() : flag_(std::make_shared< std::atomic<bool> >(false))
+    {}
+    void cancel() { flag_->store(true); }
+    bool cancelled() const { return flag_->load(); }
+
+private:
+    std::shared_ptr< std::atomic<bool> > flag_;
+};
+
+template<typename GenType>
+class CancellationCriteria : public StoppingCriteria<GenType>
+{
+public:
+    CancellationCriteria(const CancellationToken &token) : token_(token) {}
+    virtual bool stop(unsigned long, const Population<GenType> &) override
+    {
+        return token_.cancelled();
+    }
+
+private:
+    const CancellationToken token_;
+};
+
+template<typename GenType>
+class CompositeCriteria : public StoppingCriteria<GenType>
+{
+public:
+    void add(std::unique_ptr< StoppingCriteria<GenType> > criteria)
+    {
+        criteria_.push_back(std::move(criteria));
+    }
+    virtual void reset() override
+    {
+        for(auto &criteria : criteria_) criteria->reset();
+    }
+    virtual void update(const Statistics &statistics) override
+    {
+        for(auto &criteria : criteria_) criteria->update(statistics);
+    }
+
+protected:
+    std::vector< std::unique_ptr< StoppingCriteria<GenType> > > criteria_;
+};
+
+// Stops when any of the criteria is met (OR)
+template<typename GenType>
+class AnyCriteria : public CompositeCriteria<GenType>
+{
+public:
+    virtual bool stop(unsigned long iterations,
+                      const Population<GenType> &population) override
+    {
+        for(auto &criteria : this->criteria_)
+        {
+            if(criteria->stop(iterations, population)) return true;
+        }
+        return false;
+    }
+};
+
+// Stops when all of the criteria are met (AND)
+template<typename GenType>
+class AllCriteria : public CompositeCriteria<GenType>
+{
+public:
+    virtual bool stop(unsigned long iterations,
+                      const Population<GenType> &population) override
+    {
+        for(auto &criteria : this->criteria_)
+        {
+            if(!criteria->stop(iterations, population)) return false;
+        }
+        return !this->criteria_.empty();
+    }
+};
+
+template<typename GenType, typename... Criteria>
+std::unique_ptr< AnyCriteria<GenType> > anyOf(Criteria &&... criteria)
+{
+    auto composite = std::make_unique< AnyCriteria<GenType> >();
+    int expand[] = {0,
+        (composite->add(std::forward<Criteria>(criteria)), 0)...};
+    (void)expand;
+    return composite;
+}
+
+template<typename GenType, typename... Criteria>
+std::unique_ptr< AllCriteria<GenType> > allOf(Criteria &&... criteria)
+{
+    auto composite = std::make_unique< AllCriteria<GenType> >();
+    int expand[] = {0,
+        (composite->add(std::forward<Criteria>(criteria)), 0)...};
+    (void)expand;
+    return composite;
+}
+
 }
 
 #endif // STOPPINGCRITERIA_H
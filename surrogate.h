@@ -0,0 +1,182 @@
+#ifndef SURROGATE_H
+#define SURROGATE_H
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+#include "organism.h"
+#include "niching.h"
+#include "geneticalgorithm.h"
+
+namespace ga
+{
+
+// Counters of the offspring pre-screening
+struct SurrogateStatistics
+{
+    // Offspring ranked by the surrogate
+    unsigned long screened = 0;
+    // Screened offspring which were sent to the fitness function
+    unsigned long evaluated = 0;
+    // Offspring whose chromosome was already evaluated
+    unsigned long cached = 0;
+    // True evaluations avoided, including the cached ones
+    unsigned long saved = 0;
+    // Mean absolute error of the predictions checked against the fitness
+    double meanAbsoluteError = 0;
+    // Spearman correlation of predicted and true fitness of the evaluated
+    // offspring of the last generation
+    double rankCorrelation = 0;
+};
+
+// Cheap model of the fitness function built from evaluated organisms
+template<typename GenType>
+class Surrogate
+{
+public:
+    virtual void reset() {}
+    virtual void add(const Organism<GenType> &) = 0;
+    // Whether enough organisms were seen to make predictions
+    virtual bool ready() const = 0;
+    virtual double predict(const std::vector<GenType> &) = 0;
+    // Finds the fitness of an already evaluated chromosome
+    virtual bool lookup(const std::vector<GenType> &, double &)
+    {
+        return false;
+    }
+    virtual ~Surrogate() = default;
+};
+
+// Inverse distance weighted k nearest neighbors regression over an archive
+// of evaluated organisms. The archive is indexed with a spatial index which
+// is extended on every insertion and only rebuilt when the archive doubles
+// or the typical neighbor distance drifts away from its cell size. The
+// oldest half of the archive is dropped once it exceeds capacity.
+template<typename GenType>
+class NearestNeighborSurrogate : public Surrogate<GenType>
+{
+public:
+    NearestNeighborSurrogate(size_t neighbors = 5, size_t capacity = 5000) :
+        neighbors_(std::max<size_t>(neighbors, 1)),
+        capacity_(std::max(capacity, 2 * neighbors_)) {}
+
+    void reset() override
+    {
+        archive_.clear();
+        radius_ = 0;
+        indexed_ = 0;
+    }
+
+    void add(const Organism<GenType> &org) override
+    {
+        // Fitness of infeasible organisms is not the fitness function's
+        if(org.violation > 0) return;
+        double fitness;
+        if(lookup(org.chromosome, fitness)) return;
+        archive_.push_back(org);
+        if(!ready()) return;
+        if(archive_.size() > capacity_)
+        {
+            archive_.erase(archive_.begin(),
+                           archive_.begin() + archive_.size() / 2);
+            rebuild();
+        }
+        else if(archive_.size() >= 2 * indexed_)
+        {
+            rebuild();
+        }
+        else
+        {
+            index_.insert(archive_.size() - 1);
+        }
+    }
+
+    bool ready() const override
+    {
+        return archive_.size() >= 2 * neighbors_;
+    }
+
+    bool lookup(const std::vector<GenType> &point, double &fitness) override
+    {
+        if(!ready()) return false;
+        bool found = false;
+        index_.forEachNeighbor(point, 0, [&](size_t i, double) {
+            fitness = archive_[i].fitness;
+            found = true;
+        });
+        return found;
+    }
+
+    double predict(const std::vector<GenType> &point) override
+    {
+        found_.clear();
+        index_.forEachNeighbor(point, 2 * radius_, [&](size_t i, double d) {
+            found_.emplace_back(d, i);
+        });
+        if(found_.size() < neighbors_)
+        {
+            found_.clear();
+            for(size_t i = 0; i < archive_.size(); ++i)
+            {
+                found_.emplace_back(distance(point, archive_[i].chromosome),
+                                    i);
+            }
+        }
+        const size_t count = std::min(neighbors_, found_.size());
+        std::partial_sort(found_.begin(), found_.begin() + count,
+                          found_.end());
+        // Follow the typical distance to the k-th neighbor
+        radius_ = 0.9 * radius_ + 0.15 * found_[count - 1].first;
+        radius_ = std::max(radius_, 1e-9);
+        if(radius_ > 2 * cellSize_ || radius_ < cellSize_ / 2) rebuild();
+
+        double weights = 0, sum = 0;
+        for(size_t i = 0; i < count; ++i)
+        {
+            const double d = found_[i].first;
+            const double fitness = archive_[found_[i].second].fitness;
+            if(d == 0) return fitness;
+            weights += 1 / (d * d);
+            sum += fitness / (d * d);
+        }
+        return sum / weights;
+    }
+
+private:
+    const size_t neighbors_;
+    const size_t capacity_;
+    Population<GenType> archive_;
+    typename NeighborIndex<GenType>::type index_;
+    std::vector< std::pair<double, size_t> > found_;
+    double radius_ = 0;
+    double cellSize_ = 0;
+    size_t indexed_ = 0;
+
+    void rebuild()
+    {
+        if(radius_ <= 0)
+        {
+            // Start from the spread of the first organisms
+            const size_t sample = std::min<size_t>(archive_.size(), 8);
+            double sum = 0;
+            size_t pairs = 0;
+            for(size_t i = 0; i < sample; ++i)
+            {
+                for(size_t j = i + 1; j < sample; ++j, ++pairs)
+                {
+                    sum += distance(archive_[i].chromosome,
+                                    archive_[j].chromosome);
+                }
+            }
+            radius_ = (pairs && sum > 0) ? sum / pairs / 2 : 1;
+        }
+        cellSize_ = radius_;
+        index_.build(archive_, cellSize_);
+        indexed_ = archive_.size();
+    }
+};
+
+}
+
+#endif // SURROGATE_H